@@ -0,0 +1,70 @@
+/*
+arch - the library sizes compiled for the instruction set of FFT_ARCH
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#include <cmath>
+#include "arch.hh"
+
+#ifndef FFT_LIBRARY_SIZES
+#define FFT_LIBRARY_SIZES "library.def"
+#endif
+
+/*
+Inline functions and template instantiations are weak symbols the linker
+picks only one of, so each variant keeps its own copy of Complex and of the
+recursion in a namespace of its own, FFT_ARCH like avx2.
+*/
+namespace FFT_ARCH {
+#include "complex.hh"
+#include "fft.hh"
+}
+
+#define FFT_PASTE(A, B) A##B
+#define FFT_KERNELS(ARCH) FFT_PASTE(ARCH, _kernels)
+
+namespace FFT {
+
+template <typename PLAN, typename T>
+static inline void transform(T *out, const T *in)
+{
+	typedef FFT_ARCH::Complex<T> TYPE;
+	static PLAN plan;
+	plan(reinterpret_cast<TYPE *>(out), reinterpret_cast<const TYPE *>(in));
+}
+
+template <typename T>
+static bool forward(T *out, const T *in, int bins)
+{
+	switch (bins) {
+#define FFT_SIZE(BINS) case BINS: transform<FFT_ARCH::FFT::Forward<BINS, FFT_ARCH::Complex<T>>>(out, in); return true;
+#include FFT_LIBRARY_SIZES
+#undef FFT_SIZE
+	}
+	return false;
+}
+
+template <typename T>
+static bool backward(T *out, const T *in, int bins)
+{
+	switch (bins) {
+#define FFT_SIZE(BINS) case BINS: transform<FFT_ARCH::FFT::Backward<BINS, FFT_ARCH::Complex<T>>>(out, in); return true;
+#include FFT_LIBRARY_SIZES
+#undef FFT_SIZE
+	}
+	return false;
+}
+
+#define FFT_STRING(ARCH) #ARCH
+#define FFT_NAME(ARCH) FFT_STRING(ARCH)
+
+extern const Kernels FFT_KERNELS(FFT_ARCH) = {
+	FFT_NAME(FFT_ARCH),
+	forward<float>,
+	backward<float>,
+	forward<double>,
+	backward<double>,
+};
+
+}
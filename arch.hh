@@ -0,0 +1,35 @@
+/*
+arch - transforms of one instruction set, for the dispatch of library.cc
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef ARCH_HH
+#define ARCH_HH
+
+namespace FFT {
+
+/*
+arch.cc is compiled once per instruction set and fills one of these. The
+data is interleaved complex, the functions return false for sizes not in
+the library. Nothing else of the variants is visible, so no code of one
+instruction set can end up in the others.
+*/
+struct Kernels
+{
+	const char *name;
+	bool (*forward_float)(float *out, const float *in, int bins);
+	bool (*backward_float)(float *out, const float *in, int bins);
+	bool (*forward_double)(double *out, const double *in, int bins);
+	bool (*backward_double)(double *out, const double *in, int bins);
+};
+
+#if defined(__x86_64__)
+extern const Kernels sse2_kernels, avx2_kernels, avx512_kernels;
+#else
+extern const Kernels generic_kernels;
+#endif
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*
+archbench - time the prebuilt library on the instruction set it selects
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "library.hh"
+
+// best of a few batches of at least a millisecond, in nanoseconds per transform
+template <typename TYPE>
+static double measure(int bins)
+{
+	std::vector<TYPE> in(bins), out(bins);
+	for (int n = 0; n < bins; ++n)
+		in[n] = TYPE(std::sin(0.3 * n), std::cos(0.7 * n));
+	int count = 1;
+	for (;; count *= 2) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < count; ++i)
+			FFT::forward(out.data(), in.data(), bins);
+		if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(1))
+			break;
+	}
+	double best = 1e300;
+	for (int round = 0; round < 15; ++round) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < count; ++i)
+			FFT::forward(out.data(), in.data(), bins);
+		best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count);
+	}
+	return best;
+}
+
+/*
+The variant is picked once per process, so FFT_ARCH in the environment
+chooses the one to time, for example:
+for arch in sse2 avx2 avx512; do FFT_ARCH=$arch ./archbench; done
+*/
+int main()
+{
+	const int sizes[] = {
+#define FFT_SIZE(BINS) BINS,
+#include FFT_LIBRARY_SIZES
+#undef FFT_SIZE
+	};
+	std::cout << "arch: " << FFT::arch() << std::endl;
+	std::cout << "   size   float ns  GFLOP/s   double ns  GFLOP/s" << std::endl;
+	for (int bins : sizes) {
+		double f = measure<Complex<float>>(bins), d = measure<Complex<double>>(bins);
+		double flops = 5 * bins * std::log2(bins);
+		std::cout << std::setw(7) << bins << std::fixed << std::setprecision(1);
+		std::cout << std::setw(11) << f << std::setw(9) << flops / f;
+		std::cout << std::setw(12) << d << std::setw(9) << flops / d << std::endl;
+	}
+	return 0;
+}
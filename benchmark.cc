@@ -9,178 +9,1539 @@ You should have received a copy of the CC0 Public Domain Dedication along with t
 #include <iomanip>
 #include <random>
 #include <complex>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include "complex.hh"
 #include "fft.hh"
+#include "channelizer.hh"
+#include "resampler.hh"
+#include "hilbert.hh"
+#include "ntt.hh"
+#include "fixed.hh"
+#include "half.hh"
+#include "plan.hh"
+#include "cost.hh"
+#include "memory.hh"
+#include "ooc.hh"
+#include "peaks.hh"
+#include "multi.hh"
+#include "dct.hh"
+#include "czt.hh"
+#include "correlate.hh"
+
+typedef std::chrono::steady_clock clock_type;
+
+struct Options
+{
+	int min = 1, max = 1 << 20;
+	bool single = true, twice = true;
+	bool own = true, standard = true;
+	bool in_cache = true, out_of_cache = true;
+	int trials = 101;
+	double trial = 0.001, warmup = 0.02, budget = 0.25;
+	int pool = 64;
+	int repeat = 1;
+	int cpu = -2;
+	const char *csv = 0, *json = 0;
+	bool plot = false, sweep = false, features = false;
+};
+
+struct Result
+{
+	const char *type, *complex, *cache;
+	int run, size, batch, trials;
+	double median, p99, error, growth, flops;
+	int growth_ffts;
+	double ffts() const
+	{
+		return 1e9 / median;
+	}
+	// nominal 5 N log2 N flops per transform
+	double gflops() const
+	{
+		return 5 * size * std::log2(size) / median;
+	}
+	// real additions and multiplications the kernels actually do, from cost.hh
+	double counted() const
+	{
+		return flops / median;
+	}
+};
+
+template <int... SIZES>
+struct Sizes {};
+
+/*
+Every supported size up to 128, the sizes used by the earlier snapshots
+and powers of two, three and five times powers of two and some powers of
+ten up to 2^20. Each size is instantiated for all four complex types, so
+the list is a compromise with compile time.
+*/
+typedef Sizes<
+	1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
+	21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 38, 39, 40, 42,
+	44, 45, 46, 48, 49, 50, 51, 52, 54, 55, 56, 57, 58, 60, 62, 63, 64, 65, 66, 68,
+	69, 70, 72, 75, 76, 77, 78, 80, 81, 84, 85, 87, 88, 90, 91, 92, 93, 95, 96, 98,
+	99, 100, 102, 104, 105, 108, 110, 112, 114, 115, 116, 117, 119, 120, 121, 124, 125, 126, 128,
+	192, 256, 320, 384, 480, 512, 640, 720, 768, 882, 1000, 1024, 1080, 1280, 1536, 1920,
+	2048, 2560, 3072, 4096, 5120, 6144, 8192, 10000, 10240, 12288, 16384, 20480, 24576,
+	32768, 40960, 49152, 65536, 81920, 98304, 100000, 131072, 163840, 196608, 262144,
+	327680, 393216, 524288, 655360, 786432, 1000000, 1048576> sizes;
+
+template <typename TYPE>
+struct Names {};
+
+template <typename T>
+struct Names<Complex<T>>
+{
+	static const char *complex()
+	{
+		return "Complex";
+	}
+};
+
+template <typename T>
+struct Names<std::complex<T>>
+{
+	static const char *complex()
+	{
+		return "std::complex";
+	}
+};
+
+static const char *type_name(float)
+{
+	return "float";
+}
+
+static const char *type_name(double)
+{
+	return "double";
+}
+
+static void pin(int cpu)
+{
+#ifdef __linux__
+	if (cpu == -2)
+		cpu = sched_getcpu();
+	if (cpu < 0)
+		return;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if (sched_setaffinity(0, sizeof(set), &set))
+		std::cerr << "could not pin to cpu " << cpu << std::endl;
+#else
+	(void)cpu;
+#endif
+}
+
+template <typename FUNC>
+static double run(FUNC &transform, int count)
+{
+	auto start = clock_type::now();
+	for (int i = 0; i < count; ++i)
+		transform();
+	return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+/*
+A single transform of a small size takes less than the resolution of the
+clock, so the transform is repeated in batches of at least opt.trial
+seconds. The median and the 99th percentile are taken over the per
+transform times of the batches, after at least opt.warmup seconds.
+Large sizes get fewer trials, so the whole measurement stays in opt.budget.
+*/
+template <typename FUNC>
+static void timing(Result &result, const Options &opt, FUNC &transform)
+{
+	auto warm = clock_type::now();
+	int batch = 1;
+	double elapsed;
+	while ((elapsed = run(transform, batch)) < opt.trial && batch < (1 << 30))
+		batch *= 2;
+	while (std::chrono::duration<double>(clock_type::now() - warm).count() < opt.warmup)
+		run(transform, batch);
+	int trials = std::max(std::min(5, opt.trials), std::min(opt.trials, int(opt.budget / elapsed)));
+	std::vector<double> samples(trials);
+	for (int i = 0; i < trials; ++i)
+		samples[i] = 1e9 * run(transform, batch) / batch;
+	std::sort(samples.begin(), samples.end());
+	result.batch = batch;
+	result.trials = trials;
+	result.median = trials % 2 ? samples[trials / 2] : (samples[trials / 2 - 1] + samples[trials / 2]) / 2;
+	result.p99 = samples[std::max(0, int(std::ceil(0.99 * trials)) - 1)];
+}
 
 template <int BINS, typename TYPE>
-static void test()
+static void measure(std::vector<Result> &results, const Options &opt)
 {
 	typedef typename TYPE::value_type value_type;
-	std::random_device rd;
-	std::default_random_engine generator(rd());
+	std::default_random_engine generator(BINS);
 	std::uniform_real_distribution<value_type> noise_distribution(-1.0f, 1.0f);
 	auto noise = std::bind(noise_distribution, generator);
 
-	TYPE a[BINS], b[BINS], c[BINS];
+	FFT::Buffer<TYPE> a(BINS), b(BINS), c(BINS);
 	for (int i = 0; i < BINS; ++i)
 		a[i] = TYPE(noise(), noise());
 
+	std::unique_ptr<FFT::Forward<BINS, TYPE>> fwd(new FFT::Forward<BINS, TYPE>);
+	std::unique_ptr<FFT::Backward<BINS, TYPE>> bwd(new FFT::Backward<BINS, TYPE>);
 	FFT::Normalize<BINS, TYPE> norm;
-	FFT::Backward<BINS, TYPE> bwd;
-	FFT::Forward<BINS, TYPE> fwd;
 
-	fwd(b, a);
-	norm(b);
-	bwd(c, b);
-	norm(c);
+	(*fwd)(b.data(), a.data());
+	norm(b.data());
+	(*bwd)(c.data(), b.data());
+	norm(c.data());
 
 	value_type max_error = 0;
 	for (int i = 0; i < BINS; ++i)
-		max_error = std::max(max_error, abs(a[i] - c[i]));
+		max_error = std::max(max_error, value_type(abs(a[i] - c[i])));
 
-	int ffts = ~1 & (int)(100000000 / BINS / (log2(BINS) + 1));
-	auto start = std::chrono::system_clock::now();
-	for (int i = 0; i < ffts; i += 2) {
-		fwd(b, c);
-		norm(b);
-		bwd(c, b);
-		norm(c);
+	int growth_ffts = std::max(2, ~1 & (int)(10000000 / BINS / (log2(BINS) + 1)));
+	for (int i = 2; i < growth_ffts; i += 2) {
+		(*fwd)(b.data(), c.data());
+		norm(b.data());
+		(*bwd)(c.data(), b.data());
+		norm(c.data());
 	}
-	auto end = std::chrono::system_clock::now();
-	auto msec = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
 
 	value_type max_error_growth = 0;
 	for (int i = 0; i < BINS; ++i)
-		max_error_growth = std::max(max_error_growth, abs(a[i] - c[i]));
+		max_error_growth = std::max(max_error_growth, value_type(abs(a[i] - c[i])));
+
+	Result result;
+	result.run = 0;
+	result.type = type_name(value_type());
+	result.complex = Names<TYPE>::complex();
+	result.size = BINS;
+	result.error = max_error;
+	result.growth = max_error_growth;
+	result.growth_ffts = growth_ffts;
+	result.flops = FFT::Cost<FFT::Policy<0>, BINS>::FLOPS;
+
+	if (opt.in_cache) {
+		auto transform = [&]() { (*fwd)(b.data(), a.data()); };
+		timing(result, opt, transform);
+		result.cache = "in";
+		results.push_back(result);
+	}
+	if (opt.out_of_cache) {
+		// distinct buffers adding up to opt.pool MiB, so every transform starts from memory
+		int count = std::max(2, int(((long long)opt.pool << 20) / (2 * sizeof(TYPE) * BINS)));
+		FFT::Buffer<TYPE> in(count * (long long)BINS), out(count * (long long)BINS);
+		for (long long i = 0; i < count * (long long)BINS; ++i)
+			in[i] = a[i % BINS];
+		int k = 0;
+		auto transform = [&]() {
+			(*fwd)(out.data() + BINS * (long long)k, in.data() + BINS * (long long)k);
+			if (++k == count)
+				k = 0;
+		};
+		timing(result, opt, transform);
+		result.cache = "out";
+		results.push_back(result);
+	}
+	for (size_t i = results.size() - opt.in_cache - opt.out_of_cache; i < results.size(); ++i) {
+		const Result &r = results[i];
+		std::cerr << std::setw(6) << r.type << " " << std::setw(12) << r.complex;
+		std::cerr << " size: " << std::setw(7) << r.size << " " << std::setw(3) << r.cache << " cache";
+		std::cerr << " error: " << std::setw(11) << r.error;
+		std::cerr << " after " << std::setw(7) << r.growth_ffts << " ffts: " << std::setw(11) << r.growth;
+		std::cerr << " median: " << std::setw(10) << r.median << "ns p99: " << std::setw(10) << r.p99 << "ns";
+		std::cerr << " GFLOP/s: " << std::setw(7) << r.gflops() << " counted: " << std::setw(7) << r.counted() << std::endl;
+	}
+}
+
+template <typename TYPE>
+static void sweep(std::vector<Result> &, const Options &, Sizes<>) {}
+
+template <typename TYPE, int BINS, int... REST>
+static void sweep(std::vector<Result> &results, const Options &opt, Sizes<BINS, REST...>)
+{
+	if (opt.min <= BINS && BINS <= opt.max)
+		measure<BINS, TYPE>(results, opt);
+	sweep<TYPE>(results, opt, Sizes<REST...>());
+}
+
+static void write_csv(const char *name, const std::vector<Result> &results)
+{
+	std::ofstream csv(name);
+	csv << "# cpu: " << FFT::cpu_model() << std::endl;
+	csv << "run,type,complex,size,cache,batch,trials,median_ns,p99_ns,ffts_per_second,gflops,error,growth,growth_ffts,flops,counted_gflops" << std::endl;
+	csv << std::setprecision(9);
+	for (const Result &r : results) {
+		csv << r.run << "," << r.type << "," << r.complex << "," << r.size << "," << r.cache << ",";
+		csv << r.batch << "," << r.trials << "," << r.median << "," << r.p99 << ",";
+		csv << r.ffts() << "," << r.gflops() << "," << r.error << "," << r.growth << "," << r.growth_ffts << "," << r.flops << "," << r.counted() << std::endl;
+	}
+}
+
+static void write_json(const char *name, const std::vector<Result> &results)
+{
+	std::ofstream json(name);
+	json << std::setprecision(9);
+	json << "{\n\t\"cpu\": \"" << FFT::cpu_model() << "\",\n\t\"results\": [";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const Result &r = results[i];
+		json << (i ? ",\n" : "\n") << "\t\t{ \"run\": " << r.run << ", \"type\": \"" << r.type << "\", \"complex\": \"" << r.complex << "\"";
+		json << ", \"size\": " << r.size << ", \"cache\": \"" << r.cache << "\"";
+		json << ", \"batch\": " << r.batch << ", \"trials\": " << r.trials;
+		json << ", \"median_ns\": " << r.median << ", \"p99_ns\": " << r.p99;
+		json << ", \"ffts_per_second\": " << r.ffts() << ", \"gflops\": " << r.gflops();
+		json << ", \"error\": " << r.error << ", \"growth\": " << r.growth << ", \"growth_ffts\": " << r.growth_ffts;
+		json << ", \"flops\": " << r.flops << ", \"counted_gflops\": " << r.counted() << " }";
+	}
+	json << "\n\t]\n}" << std::endl;
+}
+
+// float.txt and double.txt for gnuplot.txt, in cache results of Complex
+static void write_plot(const std::vector<Result> &results)
+{
+	const char *types[] = { "float", "double" };
+	for (const char *type : types) {
+		std::vector<Result> rows;
+		for (const Result &r : results)
+			if (!r.run && std::string(r.type) == type && std::string(r.complex) == "Complex" && std::string(r.cache) == "in")
+				rows.push_back(r);
+		if (rows.empty())
+			continue;
+		std::ofstream txt(std::string(type) + ".txt");
+		for (const Result &r : rows) {
+			txt << "size: " << std::setw(7) << r.size;
+			txt << " error: " << std::setw(11) << r.error;
+			txt << " after " << std::setw(9) << r.growth_ffts << " ffts: " << std::setw(11) << r.growth;
+			txt << " speed: " << std::setw(12) << (long long)r.ffts();
+			txt << " median: " << std::setw(11) << r.median << " p99: " << std::setw(11) << r.p99;
+			txt << " gflops: " << std::setw(8) << r.gflops() << std::endl;
+		}
+	}
+}
+
+// median nanoseconds per call of func, timed like the sizes of the sweep
+template <typename FUNC>
+static double nanoseconds(const Options &opt, FUNC func)
+{
+	Result result;
+	timing(result, opt, func);
+	return result.median;
+}
+
+template <int BINS, typename TYPE>
+static void split(const Options &opt)
+{
+	typedef typename TYPE::value_type value_type;
+	std::default_random_engine generator(BINS);
+	std::uniform_real_distribution<value_type> noise_distribution(-1.0f, 1.0f);
+	auto noise = std::bind(noise_distribution, generator);
+
+	FFT::Buffer<TYPE> a(BINS), b(BINS), c(BINS);
+	// padded so the four arrays do not alias in the cache at power of two sizes
+	FFT::Buffer<value_type> a_re(BINS + 16), a_im(BINS + 16), b_re(BINS + 32), b_im(BINS + 48);
+	for (int i = 0; i < BINS; ++i)
+		a[i] = TYPE(a_re[i] = noise(), a_im[i] = noise());
+
+	FFT::Forward<BINS, TYPE> fwd;
+
+	auto interleaved = [&]() { fwd(b.data(), a.data()); };
+	auto separate = [&]() { fwd(b_re.data(), b_im.data(), a_re.data(), a_im.data()); };
+	auto copying = [&]() {
+		for (int j = 0; j < BINS; ++j)
+			c[j] = TYPE(a_re[j], a_im[j]);
+		fwd(b.data(), c.data());
+		for (int j = 0; j < BINS; ++j) {
+			b_re[j] = b[j].real();
+			b_im[j] = b[j].imag();
+		}
+	};
+	double ns_interleaved = nanoseconds(opt, interleaved);
+	double ns_copying = nanoseconds(opt, copying);
+	double ns_separate = nanoseconds(opt, separate);
+	interleaved();
+
+	value_type max_error = 0;
+	for (int i = 0; i < BINS; ++i)
+		max_error = std::max(max_error, abs(b[i] - TYPE(b_re[i], b_im[i])));
 
 	std::cerr << "size: " << std::setw(4) << BINS;
-	std::cerr << " error: " << std::setw(11) << max_error;
-	std::cerr << " after " << std::setw(9) << ffts << " ffts: " << std::setw(11) << max_error_growth;
-	std::cerr << " speed: " << std::setw(12) << (ffts * 1000LL) / std::max(1LL, msec.count()) << std::endl;
+	std::cerr << " split error: " << std::setw(11) << max_error;
+	std::cerr << " interleaved: " << std::setw(9) << std::lround(1e9 / ns_interleaved);
+	std::cerr << " split: " << std::setw(9) << std::lround(1e9 / ns_separate);
+	std::cerr << " split with copies: " << std::setw(9) << std::lround(1e9 / ns_copying) << std::endl;
 }
 
-int main()
+template <int CHANNELS, int TAPS, int OVERSAMPLE, typename TYPE>
+static void channelizer(const Options &opt)
 {
-	typedef double value_type;
-#if 0
-	typedef std::complex<value_type> complex_type;
-#else
-	typedef Complex<value_type> complex_type;
+	typedef typename TYPE::value_type value_type;
+	std::default_random_engine generator(CHANNELS * TAPS);
+	std::uniform_real_distribution<value_type> noise_distribution(-1.0f, 1.0f);
+	auto noise = std::bind(noise_distribution, generator);
+
+	typedef FFT::Channelizer<CHANNELS, TAPS, OVERSAMPLE, TYPE> analysis_type;
+	typedef FFT::Synthesizer<CHANNELS, TAPS, OVERSAMPLE, TYPE> synthesis_type;
+	const int STEP = analysis_type::STEP, COUNT = 64;
+	FFT::Buffer<TYPE> a(STEP * COUNT), b(CHANNELS * COUNT), c(STEP * COUNT);
+	for (int i = 0; i < STEP * COUNT; ++i)
+		a[i] = TYPE(noise(), noise());
+
+	static analysis_type analysis;
+	static synthesis_type synthesis;
+
+	// fresh banks start from silence, so the output is the input delayed by LENGTH - STEP from the first sample on
+	std::unique_ptr<analysis_type> fresh_analysis(new analysis_type);
+	std::unique_ptr<synthesis_type> fresh_synthesis(new synthesis_type);
+	(*fresh_analysis)(b.data(), a.data(), COUNT);
+	(*fresh_synthesis)(c.data(), b.data(), COUNT);
+	const int DELAY = analysis_type::LENGTH - STEP;
+	double signal = 0, error = 0;
+	for (int n = 0; n + DELAY < STEP * COUNT; ++n) {
+		signal += norm(a[n]);
+		error += norm(c[n + DELAY] - a[n]);
+	}
+
+	auto analyzing = [&]() { analysis(b.data(), a.data(), COUNT); };
+	auto synthesizing = [&]() { synthesis(c.data(), b.data(), COUNT); };
+	double ns_analysis = nanoseconds(opt, analyzing);
+	double ns_synthesis = nanoseconds(opt, synthesizing);
+
+	std::cerr << "channels: " << std::setw(4) << CHANNELS << " taps: " << std::setw(2) << TAPS << " oversample: " << OVERSAMPLE;
+	std::cerr << " channelizer Msamples/s: " << std::setw(6) << std::lround(1e3 * STEP * COUNT / ns_analysis);
+	std::cerr << " synthesizer Msamples/s: " << std::setw(6) << std::lround(1e3 * STEP * COUNT / ns_synthesis);
+	std::cerr << " reconstruction error: " << std::setw(5) << std::setprecision(3) << 10 * std::log10(error / signal) << "dB" << std::setprecision(6) << std::endl;
+}
+
+template <int IN, int OUT, int TAPS, typename TYPE>
+static void resampler(const Options &opt)
+{
+	typedef typename TYPE::value_type value_type;
+
+	typedef FFT::Resampler<IN, OUT, TYPE> resampler_type;
+	const int STEP = resampler_type::STEP, SKIP = resampler_type::SKIP, COUNT = 16;
+	const int UP = OUT / resampler_type::GCD, DOWN = IN / resampler_type::GCD;
+	FFT::Buffer<TYPE> a(TAPS + STEP * COUNT), b(SKIP * COUNT);
+	// tones well inside the pass band of both, so either can be checked against the exact signal
+	const double tones[3][2] = { { 0.05, 0.5 }, { -0.2, 0.3 }, { 0.4, 0.2 } };
+	const double band = double(IN < OUT ? IN : OUT) / double(2 * IN);
+	auto signal = [&](double t) {
+		std::complex<double> sum;
+		for (auto &tone : tones)
+			sum += std::polar(tone[1], 2 * M_PI * tone[0] * band * t);
+		return sum;
+	};
+	for (int i = 0; i < TAPS + STEP * COUNT; ++i)
+		a[i] = TYPE(signal(i).real(), signal(i).imag());
+
+	static resampler_type resample;
+
+	// time domain polyphase with TAPS taps per phase
+	static value_type h[UP * TAPS];
+	value_type cutoff = value_type(1) / value_type(2 * (UP > DOWN ? UP : DOWN));
+	for (int l = 0; l < UP * TAPS; ++l) {
+		value_type t = value_type(l) - value_type(UP * TAPS - 1) / value_type(2);
+		value_type x = value_type(2 * M_PI) * value_type(l) / value_type(UP * TAPS - 1);
+		value_type w = value_type(0.42) - value_type(0.5) * std::cos(x) + value_type(0.08) * std::cos(value_type(2) * x);
+		h[l] = value_type(UP) * w * (t == value_type(0) ? value_type(2) * cutoff : std::sin(value_type(2 * M_PI) * cutoff * t) / (value_type(M_PI) * t));
+	}
+	static value_type phases[UP][TAPS];
+	for (int p = 0; p < UP; ++p)
+		for (int i = 0; i < TAPS; ++i)
+			phases[p][i] = h[p + UP * i];
+	auto polyphase = [&]() {
+		const TYPE *x = a.data() + TAPS - 1;
+		for (int j = 0; j < SKIP * COUNT; ++j) {
+			int t = DOWN * j, base = t / UP;
+			const value_type *f = phases[t % UP];
+			TYPE sum(0);
+			for (int i = 0; i < TAPS; ++i)
+				sum += f[i] * x[base - i];
+			b[j] = sum;
+		}
+	};
+
+	// blocks come one at a time from a buffer of their own like a stream, so all the next block needs is in the history
+	// output j of the fft is input time j * DOWN / UP - EDGE, the first blocks still see the zero history
+	double fft_error = 0, polyphase_error = 0;
+	std::unique_ptr<resampler_type> fresh(new resampler_type);
+	FFT::Buffer<TYPE> block(STEP);
+	for (int i = 0; i < COUNT; ++i) {
+		std::copy(a.data() + STEP * i, a.data() + STEP * (i + 1), block.data());
+		(*fresh)(b.data() + SKIP * i, block.data());
+	}
+	for (int j = 2 * resampler_type::EDGE * UP / DOWN + 1; j < SKIP * COUNT; ++j)
+		fft_error = std::max(fft_error, std::abs(std::complex<double>(b[j].real(), b[j].imag()) - signal(double(DOWN) * j / UP - resampler_type::EDGE)));
+	polyphase();
+	for (int j = 0; j < SKIP * COUNT; ++j)
+		polyphase_error = std::max(polyphase_error, std::abs(std::complex<double>(b[j].real(), b[j].imag()) - signal(TAPS - 1 + double(DOWN) * j / UP - double(UP * TAPS - 1) / (2 * UP))));
+
+	auto frequency = [&]() { resample(b.data(), a.data(), COUNT); };
+	double ns_frequency = nanoseconds(opt, frequency);
+	double ns_time = nanoseconds(opt, polyphase);
+
+	std::cerr << "resample: " << std::setw(4) << IN << " -> " << std::setw(4) << OUT;
+	std::cerr << " fft Msamples/s: " << std::setw(6) << std::lround(1e3 * STEP * COUNT / ns_frequency) << " error: " << std::setw(11) << fft_error;
+	std::cerr << " polyphase " << TAPS << " taps Msamples/s: " << std::setw(6) << std::lround(1e3 * STEP * COUNT / ns_time) << " error: " << std::setw(11) << polyphase_error << std::endl;
+}
+
+template <int BINS, int TAPS, typename TYPE>
+static void hilbert(const Options &opt)
+{
+	typedef typename TYPE::value_type value_type;
+	std::default_random_engine generator(BINS * TAPS);
+	std::uniform_real_distribution<value_type> noise_distribution(-1.0f, 1.0f);
+	auto noise = std::bind(noise_distribution, generator);
+
+	typedef FFT::Hilbert<BINS, TAPS, TYPE> hilbert_type;
+	const int STEP = hilbert_type::STEP, DELAY = hilbert_type::DELAY, COUNT = 16;
+	FFT::Buffer<value_type> a(TAPS + STEP * COUNT);
+	FFT::Buffer<TYPE> b(STEP * COUNT);
+	for (int i = 0; i < TAPS + STEP * COUNT; ++i)
+		a[i] = noise();
+
+	static hilbert_type transform;
+
+	// time domain, only the odd taps are not zero
+	const int ODD = (DELAY + 1) / 2;
+	static value_type h[ODD];
+	for (int i = 0; i < ODD; ++i) {
+		int m = 2 * i + 1;
+		value_type x = value_type(2 * M_PI) * value_type(DELAY + m) / value_type(TAPS - 1);
+		h[i] = (value_type(0.42) - value_type(0.5) * std::cos(x) + value_type(0.08) * std::cos(value_type(2) * x)) * value_type(2) / (value_type(M_PI) * value_type(m));
+	}
+	auto direct = [&]() {
+		const value_type *x = a.data() + TAPS - 1 - DELAY;
+		for (int n = 0; n < STEP * COUNT; ++n) {
+			value_type sum = 0;
+			for (int i = 0; i < ODD; ++i)
+				sum += h[i] * (x[n - 2 * i - 1] - x[n + 2 * i + 1]);
+			b[n] = TYPE(x[n], sum);
+		}
+	};
+
+	auto frequency = [&]() { transform(b.data(), a.data(), COUNT); };
+	double ns_frequency = nanoseconds(opt, frequency);
+	double ns_time = nanoseconds(opt, direct);
+
+	std::cerr << "hilbert: " << std::setw(4) << BINS << " bins " << std::setw(4) << TAPS << " taps";
+	std::cerr << " fft Msamples/s: " << std::setw(6) << std::lround(1e3 * STEP * COUNT / ns_frequency);
+	std::cerr << " direct Msamples/s: " << std::setw(6) << std::lround(1e3 * STEP * COUNT / ns_time) << std::endl;
+}
+
+template <int BINS, typename TYPE>
+static void ntt(const Options &opt)
+{
+	typedef typename TYPE::value_type value_type;
+	std::default_random_engine generator(BINS);
+	std::uniform_int_distribution<uint32_t> digit_distribution(0, 65535);
+	auto digit = std::bind(digit_distribution, generator);
+
+	const int HALF = BINS / 2;
+	FFT::Buffer<uint32_t> a(HALF), b(HALF);
+	FFT::Buffer<uint64_t> exact(BINS), rounded(BINS);
+	FFT::Buffer<TYPE> z(BINS), y(BINS);
+	for (int i = 0; i < HALF; ++i) {
+		a[i] = digit();
+		b[i] = digit();
+	}
+
+	static FFT::Convolution<BINS> conv;
+	static FFT::Forward<BINS, TYPE> fwd;
+	static FFT::Backward<BINS, TYPE> bwd;
+
+	// both inputs packed into one complex fft, the product of their spectra separated on the fly
+	value_type worst = 0;
+	auto convolve = [&]() {
+		for (int n = 0; n < BINS; ++n)
+			z[n] = n < HALF ? TYPE(a[n], b[n]) : TYPE(0);
+		fwd(y.data(), z.data());
+		for (int k = 0; k < BINS; ++k) {
+			TYPE p(y[k]), q(conj(y[(BINS - k) % BINS]));
+			TYPE s(p + q), d(p - q);
+			z[k] = (value_type(0.25) / value_type(BINS)) * s * TYPE(d.imag(), -d.real());
+		}
+		bwd(y.data(), z.data());
+		for (int n = 0; n < BINS - 1; ++n) {
+			value_type r = std::nearbyint(y[n].real());
+			worst = std::max(worst, std::abs(y[n].real() - r));
+			rounded[n] = r;
+		}
+	};
+
+	auto modular = [&]() { conv(exact.data(), a.data(), HALF, b.data(), HALF); };
+	double ns_modular = nanoseconds(opt, modular);
+	double ns_floating = nanoseconds(opt, convolve);
+
+	int wrong = 0;
+	for (int n = 0; n < BINS - 1; ++n)
+		wrong += exact[n] != rounded[n];
+
+	std::cerr << "size: " << std::setw(7) << BINS << " 16 bit digits";
+	std::cerr << " ntt convs/s: " << std::setw(7) << std::lround(1e9 / ns_modular);
+	std::cerr << " fft convs/s: " << std::setw(7) << std::lround(1e9 / ns_floating);
+	std::cerr << " fft worst rounding: " << std::setw(9) << worst << " wrong: " << wrong << std::endl;
+}
+
+template <int BINS, typename TYPE>
+static double fixed_snr(const TYPE *ref, const FFT::Fixed<int16_t> *out, int exponent)
+{
+	typedef typename TYPE::value_type value_type;
+	value_type signal = 0, noise = 0;
+	for (int k = 0; k < BINS; ++k) {
+		TYPE v(std::ldexp(value_type(out[k].real()), exponent), std::ldexp(value_type(out[k].imag()), exponent));
+		signal += norm(ref[k]);
+		noise += norm(ref[k] - v);
+	}
+	return 10 * std::log10(signal / noise);
+}
+
+template <int BINS, typename TYPE>
+static void fixed(const Options &opt)
+{
+	std::default_random_engine generator(BINS);
+	std::uniform_int_distribution<int> sample_distribution(-32768, 32767);
+	auto sample = std::bind(sample_distribution, generator);
+
+	typedef FFT::Fixed<int16_t> Q15;
+	typedef FFT::Fixed<int32_t> Q31;
+	FFT::Buffer<Q15> a(BINS), b(BINS), c(BINS);
+	FFT::Buffer<TYPE> d(BINS);
+	for (int i = 0; i < BINS; ++i)
+		a[i] = Q15(sample(), sample());
+
+	FFT::Forward<BINS, TYPE> fwd;
+	static FFT::FixedForward<BINS, Q15> fwd15;
+	static FFT::FixedForward<BINS, Q31> fwd31;
+
+	auto convert = [&](int n) { return TYPE(a[n].real(), a[n].imag()); };
+	int e31 = 0, e15 = 0;
+	auto floating = [&]() { fwd(d.data(), FFT::load(convert)); };
+	auto q31 = [&]() { e31 = fwd31(b.data(), a.data()); };
+	auto q15 = [&]() { e15 = fwd15(c.data(), a.data()); };
+	double ns_floating = nanoseconds(opt, floating);
+	double ns_q31 = nanoseconds(opt, q31);
+	double ns_q15 = nanoseconds(opt, q15);
+
+	std::cerr << "size: " << std::setw(4) << BINS << " int16 in and out";
+	std::cerr << " float: " << std::setw(9) << std::lround(1e9 / ns_floating);
+	std::cerr << " q31: " << std::setw(9) << std::lround(1e9 / ns_q31);
+	std::cerr << " snr: " << std::setw(5) << std::setprecision(3) << fixed_snr<BINS, TYPE>(d.data(), b.data(), e31) << "dB";
+	std::cerr << " q15: " << std::setw(9) << std::lround(1e9 / ns_q15);
+	std::cerr << " snr: " << std::setw(5) << std::setprecision(3) << fixed_snr<BINS, TYPE>(d.data(), c.data(), e15) << "dB" << std::setprecision(6) << std::endl;
+}
+
+template <typename STORAGE, typename TYPE>
+static double half_error(const TYPE *ref, const FFT::Complex16<STORAGE> *out, int bins)
+{
+	double signal = 0, noise = 0;
+	for (int k = 0; k < bins; ++k) {
+		TYPE v(out[k].real(), out[k].imag());
+		signal += norm(ref[k]);
+		noise += norm(ref[k] - v);
+	}
+	return std::sqrt(noise / signal);
+}
+
+template <int BINS, typename TYPE>
+static void half(const Options &opt)
+{
+	std::default_random_engine generator(BINS);
+	std::uniform_real_distribution<float> sample_distribution(-1, 1);
+	auto sample = std::bind(sample_distribution, generator);
+
+	typedef FFT::Complex16<FFT::Half> H;
+	typedef FFT::Complex16<FFT::BFloat16> B;
+	FFT::Buffer<TYPE> a(BINS), b(BINS);
+	FFT::Buffer<H> c(BINS), d(BINS);
+	FFT::Buffer<B> e(BINS), f(BINS);
+	for (int i = 0; i < BINS; ++i) {
+		c[i] = H(sample(), sample());
+		e[i] = B(c[i].real(), c[i].imag());
+		a[i] = TYPE(c[i].real(), c[i].imag());
+	}
+
+	static FFT::Forward<BINS, TYPE> fwd;
+	static FFT::HalfForward<BINS, TYPE> fwd16;
+
+	auto single = [&]() { fwd(b.data(), a.data()); };
+	auto binary16 = [&]() { fwd16(d.data(), c.data()); };
+	auto bfloat16 = [&]() { fwd16(f.data(), e.data()); };
+	double ns_single = nanoseconds(opt, single);
+	double ns_binary16 = nanoseconds(opt, binary16);
+	double ns_bfloat16 = nanoseconds(opt, bfloat16);
+	single();
+	double half_err = half_error(b.data(), d.data(), BINS);
+	auto widen = [&](int n) { return TYPE(e[n].real(), e[n].imag()); };
+	fwd(b.data(), FFT::load(widen));
+	double bf16_err = half_error(b.data(), f.data(), BINS);
+
+	std::cerr << "size: " << std::setw(7) << BINS << " computed in float";
+	std::cerr << " float io: " << std::setw(7) << std::lround(1e9 / ns_single);
+	std::cerr << " half io: " << std::setw(7) << std::lround(1e9 / ns_binary16);
+	std::cerr << " error: " << std::setw(9) << half_err;
+	std::cerr << " bfloat16 io: " << std::setw(7) << std::lround(1e9 / ns_bfloat16);
+	std::cerr << " error: " << std::setw(9) << bf16_err << std::endl;
+}
+
+template <int BINS, typename TYPE>
+static void planner()
+{
+	auto start = clock_type::now();
+	FFT::Wisdom wisdom;
+	FFT::PlannedForward<BINS, TYPE> fwd(FFT::EXHAUSTIVE, wisdom);
+	double planning = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+	std::cerr << "size: " << std::setw(5) << BINS << " planned in " << std::setw(4) << std::lround(planning) << "ms";
+	for (auto &c : fwd.candidates)
+		std::cerr << " " << c.radices << ": " << std::lround(c.ns) << "ns";
+	std::cerr << " picked: " << fwd.factorization() << std::endl;
+}
+
+template <int BINS, typename TYPE, int... RADICES>
+static void radices(const Options &opt)
+{
+	typedef FFT::Radices<RADICES...> plan_type;
+	std::default_random_engine generator(BINS);
+	typedef typename TYPE::value_type value_type;
+	std::uniform_real_distribution<value_type> sample_distribution(-1, 1);
+	auto sample = std::bind(sample_distribution, generator);
+
+	std::unique_ptr<FFT::Forward<BINS, TYPE>> fwd(new FFT::Forward<BINS, TYPE>);
+	std::unique_ptr<FFT::Backward<BINS, TYPE>> bwd(new FFT::Backward<BINS, TYPE>);
+	std::unique_ptr<FFT::Forward<BINS, TYPE, plan_type>> fwd_plan(new FFT::Forward<BINS, TYPE, plan_type>);
+	std::unique_ptr<FFT::Backward<BINS, TYPE, plan_type>> bwd_plan(new FFT::Backward<BINS, TYPE, plan_type>);
+	FFT::Buffer<TYPE> a(BINS), b(BINS), c(BINS);
+	for (int i = 0; i < BINS; ++i)
+		a[i] = TYPE(sample(), sample());
+
+	auto deviation = [&]() {
+		value_type max = 0;
+		for (int i = 0; i < BINS; ++i)
+			max = std::max(max, abs(b[i] - c[i]));
+		return max / std::sqrt(value_type(BINS));
+	};
+	(*fwd)(b.data(), a.data());
+	(*fwd_plan)(c.data(), a.data());
+	value_type forward_error = deviation();
+	(*bwd)(b.data(), a.data());
+	(*bwd_plan)(c.data(), a.data());
+	value_type backward_error = deviation();
+
+	auto planned = [&]() { (*fwd_plan)(c.data(), a.data()); };
+	auto standard = [&]() { (*fwd)(b.data(), a.data()); };
+	double ns_planned = nanoseconds(opt, planned);
+	double ns_standard = nanoseconds(opt, standard);
+
+	std::cerr << "radices: " << std::setw(5) << BINS << " radix(s)/stride(s):";
+	for (int s = 0; s < plan_type::STAGES; ++s)
+		std::cerr << " " << plan_type::radix(s) << "/" << plan_type::stride(s);
+	std::cerr << " forward error: " << std::setw(11) << forward_error << " backward error: " << std::setw(11) << backward_error;
+	std::cerr << " transforms/s: " << std::setw(7) << std::lround(1e9 / ns_planned) << " default: " << std::setw(7) << std::lround(1e9 / ns_standard) << std::endl;
+}
+
+template <int BINS, typename TYPE>
+static void cost()
+{
+	typedef FFT::Cost<FFT::Policy<0>, BINS> model;
+	long long cache = 1 << 20;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+	if (sysconf(_SC_LEVEL2_CACHE_SIZE) > 0)
+		cache = sysconf(_SC_LEVEL2_CACHE_SIZE);
 #endif
+	long long nominal = std::llround(5 * BINS * std::log2(BINS));
+	std::cerr << "size: " << std::setw(7) << BINS << " adds: " << std::setw(9) << model::ADDS << " muls: " << std::setw(9) << model::MULS;
+	std::cerr << " of nominal: " << std::setw(9) << nominal << " twiddles: " << std::setw(8) << model::TWIDDLES;
+	std::cerr << " depth: " << model::DEPTH << " passes with " << (cache >> 10) << "KiB: " << model::passes(cache, sizeof(TYPE)) << std::endl;
+}
 
-#if 1
-	test<1, complex_type>();
-	test<2, complex_type>();
-	test<3, complex_type>();
-	test<4, complex_type>();
-	test<5, complex_type>();
-	test<6, complex_type>();
-	test<7, complex_type>();
-	test<8, complex_type>();
-	test<9, complex_type>();
-	test<10, complex_type>();
-	test<11, complex_type>();
-	test<12, complex_type>();
-	test<13, complex_type>();
-	test<14, complex_type>();
-	test<15, complex_type>();
-	test<16, complex_type>();
-	test<17, complex_type>();
-	test<18, complex_type>();
-	test<19, complex_type>();
-	test<20, complex_type>();
-	test<21, complex_type>();
-	test<22, complex_type>();
-	test<23, complex_type>();
-	test<24, complex_type>();
-	test<25, complex_type>();
-	test<26, complex_type>();
-	test<27, complex_type>();
-	test<28, complex_type>();
-	test<29, complex_type>();
-	test<30, complex_type>();
-	test<31, complex_type>();
-	test<32, complex_type>();
-	test<33, complex_type>();
-	test<34, complex_type>();
-	test<35, complex_type>();
-	test<36, complex_type>();
-	test<38, complex_type>();
-	test<39, complex_type>();
-	test<40, complex_type>();
-	test<42, complex_type>();
-	test<44, complex_type>();
-	test<45, complex_type>();
-	test<46, complex_type>();
-	test<48, complex_type>();
-	test<49, complex_type>();
-	test<50, complex_type>();
-	test<51, complex_type>();
-	test<52, complex_type>();
-	test<54, complex_type>();
-	test<55, complex_type>();
-	test<56, complex_type>();
-	test<57, complex_type>();
-	test<58, complex_type>();
-	test<60, complex_type>();
-	test<62, complex_type>();
-	test<63, complex_type>();
-	test<64, complex_type>();
-	test<65, complex_type>();
-	test<66, complex_type>();
-	test<68, complex_type>();
-	test<69, complex_type>();
-	test<70, complex_type>();
-	test<72, complex_type>();
-	test<75, complex_type>();
-	test<76, complex_type>();
-	test<77, complex_type>();
-	test<78, complex_type>();
-	test<80, complex_type>();
-	test<81, complex_type>();
-	test<84, complex_type>();
-	test<85, complex_type>();
-	test<87, complex_type>();
-	test<88, complex_type>();
-	test<90, complex_type>();
-	test<91, complex_type>();
-	test<93, complex_type>();
-	test<92, complex_type>();
-	test<95, complex_type>();
-	test<96, complex_type>();
-	test<98, complex_type>();
-	test<99, complex_type>();
-	test<100, complex_type>();
-	test<102, complex_type>();
-	test<104, complex_type>();
-	test<105, complex_type>();
-	test<108, complex_type>();
-	test<110, complex_type>();
-	test<112, complex_type>();
-	test<114, complex_type>();
-	test<115, complex_type>();
-	test<116, complex_type>();
-	test<117, complex_type>();
-	test<119, complex_type>();
-	test<120, complex_type>();
-	test<121, complex_type>();
-	test<124, complex_type>();
-	test<125, complex_type>();
-	test<126, complex_type>();
-	test<128, complex_type>();
-	test<256, complex_type>();
-	test<480, complex_type>();
-	test<512, complex_type>();
-	test<640, complex_type>();
-	test<720, complex_type>();
-	test<882, complex_type>();
-	test<1024, complex_type>();
-	test<1080, complex_type>();
-	test<1280, complex_type>();
-	test<1920, complex_type>();
-	test<4096, complex_type>();
+// a counter of this thread from perf_event_open, -1 where the kernel or the machine has none
+class Event
+{
+	int fd;
+public:
+	enum { PAGE_FAULTS, DTLB_MISSES };
+	Event(int which) : fd(-1)
+	{
+#ifdef __linux__
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = which == PAGE_FAULTS ? PERF_TYPE_SOFTWARE : PERF_TYPE_HW_CACHE;
+		attr.config = which == PAGE_FAULTS ? PERF_COUNT_SW_PAGE_FAULTS :
+			PERF_COUNT_HW_CACHE_DTLB | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
 #else
-	test<114, complex_type>();
+		(void)which;
 #endif
+	}
+	~Event()
+	{
+#ifdef __linux__
+		if (fd >= 0)
+			close(fd);
+#endif
+	}
+	long long read() const
+	{
+		long long value = -1;
+#ifdef __linux__
+		if (fd >= 0 && ::read(fd, &value, sizeof(value)) != sizeof(value))
+			value = -1;
+#endif
+		return value;
+	}
+};
+
+/*
+Forward transforms over 64MiB of distinct buffers, as in the out of cache
+sweep, on pages of the base size and on huge pages. Where the machine has
+no counter for dTLB misses, virtual machines for example, the page faults
+of filling the buffers tell how many translations the working set needs.
+*/
+template <FFT::Pages PAGES, int BINS, typename TYPE>
+static void paged(const char *name, FFT::Forward<BINS, TYPE> &fwd, const TYPE *a)
+{
+	const int COUNT = std::max(2, int((64LL << 20) / (2 * sizeof(TYPE) * BINS))), ROUNDS = 5;
+	Event faults(Event::PAGE_FAULTS), misses(Event::DTLB_MISSES);
+	long long filling = faults.read();
+	FFT::Buffer<TYPE, PAGES> in(COUNT * (long long)BINS), out(COUNT * (long long)BINS);
+	filling = faults.read() - filling;
+	for (long long i = 0; i < COUNT * (long long)BINS; ++i)
+		in[i] = a[i % BINS];
+	double best = 1e300;
+	long long tlb = misses.read();
+	for (int round = 0; round < ROUNDS; ++round) {
+		auto start = clock_type::now();
+		for (int k = 0; k < COUNT; ++k)
+			fwd(out.data() + BINS * (long long)k, in.data() + BINS * (long long)k);
+		best = std::min(best, std::chrono::duration<double>(clock_type::now() - start).count());
+	}
+	tlb = misses.read() - tlb;
+	std::cerr << "size: " << std::setw(7) << BINS << " " << std::setw(11) << name;
+	std::cerr << " huge: " << (FFT::huge_bytes(in.data()) ? "yes" : " no") << " faults filling: " << std::setw(6) << filling;
+	std::cerr << " dTLB misses per fft: " << std::setw(8);
+	if (misses.read() < 0)
+		std::cerr << "n/a";
+	else
+		std::cerr << tlb / (ROUNDS * COUNT);
+	std::cerr << " best: " << std::setw(10) << std::lround(1e9 * best / COUNT) << "ns" << std::endl;
+}
+
+template <int BINS, typename TYPE>
+static void pages()
+{
+	typedef typename TYPE::value_type value_type;
+	std::default_random_engine generator(BINS);
+	std::uniform_real_distribution<value_type> noise_distribution(-1.0f, 1.0f);
+	auto noise = std::bind(noise_distribution, generator);
+	FFT::Buffer<TYPE> a(BINS);
+	for (int i = 0; i < BINS; ++i)
+		a[i] = TYPE(noise(), noise());
+	static FFT::Forward<BINS, TYPE> fwd;
+	paged<FFT::BASE_PAGES>("base", fwd, a.data());
+	paged<FFT::TRANSPARENT_HUGE_PAGES>("transparent", fwd, a.data());
+	paged<FFT::EXPLICIT_HUGE_PAGES>("explicit", fwd, a.data());
+}
+
+// sequential write and read of a file in blocks of 8MiB, flushed and dropped from the page cache
+static bool drive(double *write_rate, double *read_rate, const char *name, const char *data, long long bytes)
+{
+	const long long BLOCK = 8 << 20;
+	int fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return false;
+	auto start = clock_type::now();
+	bool done = true;
+	for (long long i = 0; done && i < bytes; i += BLOCK)
+		done = pwrite(fd, data + i, std::min(BLOCK, bytes - i), i) == std::min(BLOCK, bytes - i);
+	done = done && !fsync(fd);
+	*write_rate = bytes / std::chrono::duration<double>(clock_type::now() - start).count() / 1e9;
+	posix_fadvise(fd, 0, bytes, POSIX_FADV_DONTNEED);
+	std::vector<char> block(BLOCK);
+	start = clock_type::now();
+	for (long long i = 0; done && i < bytes; i += BLOCK)
+		done = pread(fd, block.data(), std::min(BLOCK, bytes - i), i) == std::min(BLOCK, bytes - i);
+	*read_rate = bytes / std::chrono::duration<double>(clock_type::now() - start).count() / 1e9;
+	posix_fadvise(fd, 0, bytes, POSIX_FADV_DONTNEED);
+	return !close(fd) && done;
+}
+
+/*
+Out of core transform of a file in TMPDIR, with a quarter of the file as
+memory, against the sequential bandwidth of the same drive. Every pass
+reads and writes the whole file, so the drive moves four times the file.
+A few bins are checked against a direct sum.
+*/
+template <int N1, int N2, typename TYPE>
+static void ooc()
+{
+	typedef typename TYPE::value_type value_type;
+	const long long BINS = (long long)N1 * N2, BYTES = BINS * sizeof(TYPE);
+	std::default_random_engine generator(BINS);
+	std::uniform_real_distribution<value_type> noise_distribution(-1.0f, 1.0f);
+	auto noise = std::bind(noise_distribution, generator);
+	FFT::Buffer<TYPE> a(BINS);
+	for (long long i = 0; i < BINS; ++i)
+		a[i] = TYPE(noise(), noise());
+	const char *dir = std::getenv("TMPDIR") ? std::getenv("TMPDIR") : "/tmp";
+	std::string in = std::string(dir) + "/fft-ooc-in", out = std::string(dir) + "/fft-ooc-out";
+	double write_rate, read_rate;
+	if (!drive(&write_rate, &read_rate, in.c_str(), reinterpret_cast<const char *>(a.data()), BYTES)) {
+		std::cerr << "ooc: could not write " << in << std::endl;
+		return;
+	}
+	FFT::OutOfCoreForward<N1, N2, TYPE> fwd(BYTES / 4);
+	bool done = fwd(out.c_str(), in.c_str());
+	double seconds = fwd.seconds[0] + fwd.seconds[1], error = 0;
+	int fd = open(out.c_str(), O_RDONLY);
+	for (long long k : { 0LL, 1LL, BINS / 3, BINS - 1 }) {
+		std::complex<double> sum, w(1), step(std::polar(1.0, -2 * M_PI * k / BINS));
+		for (long long n = 0; n < BINS; ++n, w *= step)
+			sum += w * std::complex<double>(a[n].real(), a[n].imag());
+		TYPE got;
+		if (pread(fd, &got, sizeof(got), k * sizeof(TYPE)) == sizeof(got))
+			error = std::max(error, std::abs(sum - std::complex<double>(got.real(), got.imag())) / std::sqrt(double(BINS)));
+	}
+	close(fd);
+	unlink(in.c_str());
+	unlink(out.c_str());
+	std::cerr << "ooc: " << N1 << " x " << N2 << " " << type_name(value_type()) << " " << (BYTES >> 20) << "MiB with " << (BYTES >> 22) << "MiB memory";
+	if (!done) {
+		std::cerr << " failed: " << fwd.error << std::endl;
+		return;
+	}
+	std::cerr << " drive write: " << write_rate << "GB/s read: " << read_rate << "GB/s";
+	std::cerr << " passes: " << fwd.seconds[0] << "s " << fwd.seconds[1] << "s";
+	std::cerr << " effective: " << BYTES / seconds / 1e9 << "GB/s io: " << 4 * BYTES / seconds / 1e9 << "GB/s error: " << error << std::endl;
+}
+
+/*
+A few tones in a little noise, one of them next to bin 0 so its main lobe
+wraps around, against the same search, refinement and noise floor on an
+O(N^2) direct transform of the windowed frame.
+*/
+template <int BINS, typename TYPE>
+static void detect(const Options &opt, const char *name, const typename TYPE::value_type *w, int lobe)
+{
+	typedef typename TYPE::value_type value_type;
+	const int COUNT = 4;
+	const value_type THRESHOLD = 10;
+	std::default_random_engine generator(BINS);
+	std::uniform_real_distribution<value_type> noise_distribution(-1.0f, 1.0f);
+	auto noise = std::bind(noise_distribution, generator);
+
+	const double tones[COUNT][2] = { { 0.3, 1 }, { BINS / 5 + 0.25, 0.5 }, { BINS / 3 + 0.5, 0.25 }, { BINS - 7.4, 0.25 } };
+	FFT::Buffer<TYPE> a(BINS);
+	for (int n = 0; n < BINS; ++n) {
+		std::complex<double> sum(0.01 * noise(), 0.01 * noise());
+		for (auto &tone : tones)
+			sum += std::polar(tone[1], 2 * M_PI * tone[0] * n / BINS);
+		a[n] = TYPE(sum.real(), sum.imag());
+	}
+
+	std::unique_ptr<FFT::Peaks<BINS, COUNT, TYPE>> peaks(new FFT::Peaks<BINS, COUNT, TYPE>(w));
+	FFT::Peak<value_type> found[COUNT];
+	value_type floor = 0;
+	int count = 0;
+	auto search = [&]() { count = (*peaks)(found, &floor, a.data(), THRESHOLD); };
+	double ns = nanoseconds(opt, search);
+
+	std::vector<std::complex<double>> root(BINS);
+	for (int n = 0; n < BINS; ++n)
+		root[n] = std::polar(1.0, -2 * M_PI * n / BINS);
+	std::vector<double> power(BINS);
+	double energy = 0, mean = 0;
+	for (int n = 0; n < BINS; ++n)
+		energy += double(w[n]) * w[n];
+	for (int k = 0; k < BINS; ++k) {
+		std::complex<double> sum;
+		for (int n = 0; n < BINS; ++n)
+			sum += double(w[n]) * std::complex<double>(a[n].real(), a[n].imag()) * root[n * k % BINS];
+		mean += power[k] = std::norm(sum) / energy;
+	}
+	auto at = [&](int k) { return power[(k + BINS) % BINS]; };
+	std::vector<int> bins;
+	for (int k = 0; k < BINS; ++k)
+		if (power[k] > THRESHOLD * mean / BINS && power[k] > at(k - 1) && power[k] >= at(k + 1))
+			bins.push_back(k);
+	std::sort(bins.begin(), bins.end(), [&](int i, int j) { return power[i] > power[j]; });
+	bins.resize(std::min<size_t>(bins.size(), COUNT));
+	std::vector<bool> masked(BINS);
+	double rest = mean;
+	int outside = BINS;
+	for (int k : bins) {
+		for (int l = k - lobe; l <= k + lobe; ++l) {
+			if (!masked[(l + BINS) % BINS]) {
+				masked[(l + BINS) % BINS] = true;
+				rest -= at(l);
+				--outside;
+			}
+		}
+	}
+	double bin_error = 0, power_error = 0;
+	for (int i = 0; i < std::min<int>(count, bins.size()); ++i) {
+		int k = bins[i];
+		double l = std::log(at(k - 1)), c = std::log(at(k)), r = std::log(at(k + 1)), d = l - 2 * c + r;
+		double delta = d < 0 ? 0.5 * (l - r) / d : 0;
+		double bin = std::fmod(k + delta + BINS, double(BINS)), height = std::exp(c - 0.25 * (l - r) * delta);
+		double diff = std::abs(found[i].bin - bin);
+		bin_error = std::max(bin_error, std::min(diff, BINS - diff));
+		power_error = std::max(power_error, std::abs(found[i].power - height) / height);
+	}
+	double expected = rest / outside;
+
+	std::cerr << "peaks: " << std::setw(5) << BINS << " " << std::setw(8) << name << " lobe: " << peaks->main_lobe() << " of " << lobe;
+	std::cerr << " found: " << count << " of " << bins.size() << " bin error: " << std::setw(11) << bin_error;
+	std::cerr << " power error: " << std::setw(11) << power_error << " noise error: " << std::setw(11) << std::abs(floor - expected) / expected;
+	std::cerr << " frames/s: " << std::setw(7) << std::lround(1e9 / ns) << std::endl;
 }
 
+template <int BINS, typename TYPE>
+static void peaks(const Options &opt)
+{
+	typedef typename TYPE::value_type value_type;
+	FFT::Hann<BINS, value_type> hann;
+	std::vector<value_type> rect(BINS, value_type(1)), blackman(BINS);
+	for (int n = 0; n < BINS; ++n)
+		blackman[n] = value_type(0.42 - 0.5 * std::cos(2 * M_PI * n / BINS) + 0.08 * std::cos(4 * M_PI * n / BINS));
+	detect<BINS, TYPE>(opt, "hann", hann, 2);
+	detect<BINS, TYPE>(opt, "rect", rect.data(), 1);
+	detect<BINS, TYPE>(opt, "blackman", blackman.data(), 3);
+}
+
+/*
+Complex and real three dimensional transforms against an O(N^2) direct sum
+over all three dimensions, and the real round trip back to the input.
+*/
+template <int PLANES, int ROWS, int COLS, typename TYPE>
+static void multi(const Options &opt)
+{
+	typedef typename TYPE::value_type value_type;
+	const int BINS = PLANES * ROWS * COLS, HALF = COLS / 2 + 1;
+	std::default_random_engine generator(BINS);
+	std::uniform_real_distribution<value_type> noise_distribution(-1.0f, 1.0f);
+	auto noise = std::bind(noise_distribution, generator);
+
+	FFT::Buffer<TYPE> a(BINS), b(BINS), c(PLANES * ROWS * HALF);
+	FFT::Buffer<value_type> x(BINS), y(BINS);
+	for (int i = 0; i < BINS; ++i)
+		a[i] = TYPE(noise(), noise());
+	for (int i = 0; i < BINS; ++i)
+		x[i] = noise();
+
+	std::unique_ptr<FFT::Forward3D<PLANES, ROWS, COLS, TYPE>> fwd(new FFT::Forward3D<PLANES, ROWS, COLS, TYPE>);
+	std::unique_ptr<FFT::RealForward3D<PLANES, ROWS, COLS, TYPE>> real_fwd(new FFT::RealForward3D<PLANES, ROWS, COLS, TYPE>);
+	std::unique_ptr<FFT::RealBackward3D<PLANES, ROWS, COLS, TYPE>> real_bwd(new FFT::RealBackward3D<PLANES, ROWS, COLS, TYPE>);
+	auto complex_forward = [&]() { (*fwd)(b.data(), a.data()); };
+	auto real_forward = [&]() { (*real_fwd)(c.data(), x.data()); };
+	auto real_backward = [&]() { (*real_bwd)(y.data(), c.data()); };
+	double ns_complex = nanoseconds(opt, complex_forward);
+	double ns_real = nanoseconds(opt, real_forward);
+	double ns_inverse = nanoseconds(opt, real_backward);
+
+	// e^(-2 pi i (p q / PLANES + r s / ROWS + k l / COLS)) as a power of the BINS-th root of unity
+	std::vector<std::complex<double>> root(BINS);
+	for (int n = 0; n < BINS; ++n)
+		root[n] = std::polar(1.0, -2 * M_PI * n / BINS);
+	auto twiddle = [&](int p, int r, int k, int q, int s, int l) {
+		return root[((long long)p * q * ROWS * COLS + (long long)r * s * PLANES * COLS + (long long)k * l * PLANES * ROWS) % BINS];
+	};
+	double complex_error = 0, real_error = 0, round_trip_error = 0;
+	for (int q = 0; q < PLANES; ++q) {
+		for (int s = 0; s < ROWS; ++s) {
+			for (int l = 0; l < COLS; ++l) {
+				std::complex<double> sum, real_sum;
+				for (int p = 0; p < PLANES; ++p) {
+					for (int r = 0; r < ROWS; ++r) {
+						for (int k = 0; k < COLS; ++k) {
+							int n = COLS * (ROWS * p + r) + k;
+							std::complex<double> w = twiddle(p, r, k, q, s, l);
+							sum += w * std::complex<double>(a[n].real(), a[n].imag());
+							real_sum += w * double(x[n]);
+						}
+					}
+				}
+				TYPE got = b[COLS * (ROWS * q + s) + l];
+				complex_error = std::max(complex_error, std::abs(sum - std::complex<double>(got.real(), got.imag())));
+				if (l < HALF) {
+					got = c[HALF * (ROWS * q + s) + l];
+					real_error = std::max(real_error, std::abs(real_sum - std::complex<double>(got.real(), got.imag())));
+				}
+			}
+		}
+	}
+	for (int n = 0; n < BINS; ++n)
+		round_trip_error = std::max(round_trip_error, std::abs(double(y[n]) / BINS - double(x[n])));
+
+	std::cerr << "multi: " << std::setw(2) << PLANES << " x " << std::setw(2) << ROWS << " x " << std::setw(2) << COLS;
+	std::cerr << " complex/s: " << std::setw(7) << std::lround(1e9 / ns_complex) << " error: " << std::setw(11) << complex_error / std::sqrt(double(BINS));
+	std::cerr << " real/s: " << std::setw(7) << std::lround(1e9 / ns_real) << " error: " << std::setw(11) << real_error / std::sqrt(double(BINS));
+	std::cerr << " inverse/s: " << std::setw(7) << std::lround(1e9 / ns_inverse) << " round trip error: " << std::setw(11) << round_trip_error << std::endl;
+}
+
+// largest difference of a transform of x to direct(k), relative to the square root of the size like ooc
+template <typename TRANSFORM, int BINS, typename DIRECT>
+static double direct_error(const typename TRANSFORM::value_type *x, DIRECT direct)
+{
+	typedef typename TRANSFORM::value_type value_type;
+	std::unique_ptr<TRANSFORM> transform(new TRANSFORM);
+	std::vector<value_type> y(BINS);
+	(*transform)(y.data(), x);
+	double error = 0;
+	for (int k = 0; k < BINS; ++k)
+		error = std::max(error, std::abs(y[k] - direct(k)));
+	return error / std::sqrt(double(BINS));
+}
+
+/*
+The cosine and sine transforms against O(N^2) direct sums with the scaling
+of FFTW, the MDCT against its direct sum and MDCT followed by IMDCT against
+the input delayed by BINS.
+*/
+template <int BINS, typename TYPE>
+static void dct(const Options &opt)
+{
+	typedef typename TYPE::value_type value_type;
+	const int COUNT = 8;
+	std::default_random_engine generator(BINS);
+	std::uniform_real_distribution<value_type> noise_distribution(-1.0f, 1.0f);
+	auto noise = std::bind(noise_distribution, generator);
+
+	FFT::Buffer<value_type> x(BINS * COUNT), y(BINS * COUNT), z(BINS * COUNT);
+	for (int i = 0; i < BINS * COUNT; ++i)
+		x[i] = noise();
+	const value_type *a = x.data();
+
+	auto dct2 = [&](int k) {
+		double sum = 0;
+		for (int n = 0; n < BINS; ++n)
+			sum += 2 * a[n] * std::cos(M_PI * (n + 0.5) * k / BINS);
+		return sum;
+	};
+	auto dct3 = [&](int k) {
+		double sum = a[0];
+		for (int n = 1; n < BINS; ++n)
+			sum += 2 * a[n] * std::cos(M_PI * n * (k + 0.5) / BINS);
+		return sum;
+	};
+	auto dct4 = [&](int k) {
+		double sum = 0;
+		for (int n = 0; n < BINS; ++n)
+			sum += 2 * a[n] * std::cos(M_PI * (n + 0.5) * (k + 0.5) / BINS);
+		return sum;
+	};
+	auto dst2 = [&](int k) {
+		double sum = 0;
+		for (int n = 0; n < BINS; ++n)
+			sum += 2 * a[n] * std::sin(M_PI * (n + 0.5) * (k + 1) / BINS);
+		return sum;
+	};
+	auto dst3 = [&](int k) {
+		double sum = k & 1 ? -a[BINS - 1] : a[BINS - 1];
+		for (int n = 0; n < BINS - 1; ++n)
+			sum += 2 * a[n] * std::sin(M_PI * (n + 1) * (k + 0.5) / BINS);
+		return sum;
+	};
+	auto dst4 = [&](int k) {
+		double sum = 0;
+		for (int n = 0; n < BINS; ++n)
+			sum += 2 * a[n] * std::sin(M_PI * (n + 0.5) * (k + 0.5) / BINS);
+		return sum;
+	};
+	std::cerr << "dct: " << std::setw(4) << BINS;
+	std::cerr << " dct2 error: " << std::setw(11) << direct_error<FFT::DCT2<BINS, TYPE>, BINS>(a, dct2);
+	std::cerr << " dct3 error: " << std::setw(11) << direct_error<FFT::DCT3<BINS, TYPE>, BINS>(a, dct3);
+	std::cerr << " dct4 error: " << std::setw(11) << direct_error<FFT::DCT4<BINS, TYPE>, BINS>(a, dct4);
+	std::cerr << " dst2 error: " << std::setw(11) << direct_error<FFT::DST2<BINS, TYPE>, BINS>(a, dst2);
+	std::cerr << " dst3 error: " << std::setw(11) << direct_error<FFT::DST3<BINS, TYPE>, BINS>(a, dst3);
+	std::cerr << " dst4 error: " << std::setw(11) << direct_error<FFT::DST4<BINS, TYPE>, BINS>(a, dst4) << std::endl;
+
+	// X[k] = sum w[n] z[n] cos(pi (n + 1/2 + BINS / 2) (k + 1/2) / BINS) over the last 2 * BINS samples z
+	FFT::SineWindow<2 * BINS, double> window;
+	std::unique_ptr<FFT::MDCT<BINS, TYPE>> mdct(new FFT::MDCT<BINS, TYPE>);
+	std::unique_ptr<FFT::IMDCT<BINS, TYPE>> imdct(new FFT::IMDCT<BINS, TYPE>);
+	for (int i = 0; i < COUNT; ++i)
+		(*mdct)(y.data() + BINS * i, x.data() + BINS * i);
+	double mdct_error = 0, round_trip_error = 0;
+	for (int i = 1; i < COUNT; ++i) {
+		for (int k = 0; k < BINS; ++k) {
+			double sum = 0;
+			for (int n = 0; n < 2 * BINS; ++n)
+				sum += window[n] * x[BINS * (i - 1) + n] * std::cos(M_PI * (n + 0.5 + BINS / 2) * (k + 0.5) / BINS);
+			mdct_error = std::max(mdct_error, std::abs(y[BINS * i + k] - sum));
+		}
+	}
+	for (int i = 0; i < COUNT; ++i)
+		(*imdct)(z.data() + BINS * i, y.data() + BINS * i);
+	for (int n = 0; n < BINS * (COUNT - 1); ++n)
+		round_trip_error = std::max(round_trip_error, double(std::abs(z[BINS + n] - x[n])));
+
+	std::unique_ptr<FFT::DCT2<BINS, TYPE>> forward(new FFT::DCT2<BINS, TYPE>);
+	auto cosine = [&]() { (*forward)(y.data(), x.data()); };
+	auto lapped = [&]() {
+		(*mdct)(y.data(), x.data());
+		(*imdct)(z.data(), y.data());
+	};
+	double ns_dct = nanoseconds(opt, cosine);
+	double ns_mdct = nanoseconds(opt, lapped);
+	std::cerr << "dct: " << std::setw(4) << BINS << " dct2/s: " << std::setw(7) << std::lround(1e9 / ns_dct);
+	std::cerr << " mdct and imdct/s: " << std::setw(7) << std::lround(1e9 / ns_mdct);
+	std::cerr << " mdct error: " << std::setw(11) << mdct_error / std::sqrt(double(BINS)) << " round trip error: " << std::setw(11) << round_trip_error << std::endl;
+}
+
+/*
+Zoom and spiral chirp z-transforms against the O(N M) direct sum, which is
+timed along with it using a rotating phasor per point.
+*/
+template <int N, int M, typename TYPE>
+static void czt(const Options &opt, const char *name, FFT::ChirpZ<N, M, TYPE> &chirp, std::complex<double> A, std::complex<double> W)
+{
+	typedef typename TYPE::value_type value_type;
+	std::default_random_engine generator(N * M);
+	std::uniform_real_distribution<value_type> noise_distribution(-1.0f, 1.0f);
+	auto noise = std::bind(noise_distribution, generator);
+
+	FFT::Buffer<TYPE> a(N), b(M), c(M);
+	for (int n = 0; n < N; ++n)
+		a[n] = TYPE(noise(), noise());
+
+	auto transform = [&]() { chirp(b.data(), a.data()); };
+	TYPE step[M];
+	for (int k = 0; k < M; ++k) {
+		std::complex<double> s = std::pow(A, -1.0) * std::pow(W, double(k));
+		step[k] = TYPE(s.real(), s.imag());
+	}
+	auto direct = [&]() {
+		for (int k = 0; k < M; ++k) {
+			TYPE sum(0), z(1);
+			for (int n = 0; n < N; ++n, z *= step[k])
+				sum += a[n] * z;
+			c[k] = sum;
+		}
+	};
+	double ns_czt = nanoseconds(opt, transform);
+	double ns_direct = nanoseconds(opt, direct);
+
+	// A^-n W^nk = e^(nk log W - n log A)
+	std::complex<double> log_a = std::log(A), log_w = std::log(W);
+	double error = 0;
+	for (int k = 0; k < M; ++k) {
+		std::complex<double> sum;
+		for (int n = 0; n < N; ++n)
+			sum += std::complex<double>(a[n].real(), a[n].imag()) * std::exp(double(n) * k * log_w - double(n) * log_a);
+		error = std::max(error, std::abs(sum - std::complex<double>(b[k].real(), b[k].imag())));
+	}
+
+	std::cerr << "czt: " << std::setw(4) << N << " -> " << std::setw(4) << M << " " << std::setw(6) << name << " length: " << std::setw(4) << chirp.LENGTH;
+	std::cerr << " czt/s: " << std::setw(7) << std::lround(1e9 / ns_czt) << " direct/s: " << std::setw(7) << std::lround(1e9 / ns_direct);
+	std::cerr << " error: " << std::setw(11) << error / std::sqrt(double(N)) << std::endl;
+}
+
+template <int N, int M, typename TYPE>
+static void czt(const Options &opt)
+{
+	typedef typename TYPE::value_type value_type;
+	typedef FFT::ChirpZ<N, M, TYPE> chirp_type;
+	// 1kHz to 1.2kHz at 48kHz
+	const double f0 = 1000, f1 = 1200, rate = 48000;
+	std::unique_ptr<chirp_type> zoom(new chirp_type(value_type(f0), value_type(f1), value_type(rate)));
+	czt(opt, "zoom", *zoom, std::polar(1.0, 2 * M_PI * f0 / rate), std::polar(1.0, -2 * M_PI * (f1 - f0) / (M - 1) / rate));
+	// inside the unit circle, spiraling outwards by e over the whole transform
+	// in float the rounding of the angle of W grows with n k to a few 1e-4 at the last points
+	std::complex<double> A = std::polar(std::exp(-1.0 / N), 0.25), W = std::polar(std::exp(-1.0 / (double(N) * M)), -0.01);
+	std::unique_ptr<chirp_type> spiral(new chirp_type(TYPE(A.real(), A.imag()), TYPE(W.real(), W.imag())));
+	czt(opt, "spiral", *spiral, A, W);
+}
+
+/*
+Channels that are copies of one noise signal at known delays, with a little
+noise of their own, against GCC-PHAT done with O(N^2) direct transforms and
+the same peak refinement.
+*/
+template <int BINS, int CHANNELS, typename TYPE>
+static void correlate(const Options &opt, int maxlag)
+{
+	typedef typename TYPE::value_type value_type;
+	typedef FFT::Correlator<BINS, CHANNELS, TYPE> correlator_type;
+	const int FRAME = correlator_type::FRAME, HALF = correlator_type::HALF, PAIRS = correlator_type::PAIRS;
+	std::default_random_engine generator(BINS * CHANNELS);
+	std::uniform_real_distribution<value_type> noise_distribution(-1.0f, 1.0f);
+	auto noise = std::bind(noise_distribution, generator);
+
+	// channel c is the signal delayed by lag[c], spread over at most a quarter frame so most of the frames overlap
+	// and inside +-maxlag, where the peaks have neighbours on both sides for the refinement
+	const int SPREAD = std::min(maxlag - 1, FRAME / 4);
+	std::vector<int> lag(CHANNELS);
+	for (int c = 0; c < CHANNELS; ++c)
+		lag[c] = (c * 7919) % (SPREAD + 1) - SPREAD / 2;
+	std::vector<value_type> signal(FRAME + SPREAD);
+	for (auto &v : signal)
+		v = noise();
+	FFT::Buffer<value_type> in(FRAME * CHANNELS);
+	for (int c = 0; c < CHANNELS; ++c)
+		for (int n = 0; n < FRAME; ++n)
+			in[FRAME * c + n] = signal[n - lag[c] + SPREAD / 2] + value_type(0.1) * noise();
+
+	std::unique_ptr<correlator_type> correlator(new correlator_type(1, maxlag));
+	value_type delays[PAIRS], peaks[PAIRS];
+	auto estimate = [&]() { (*correlator)(delays, peaks, in.data()); };
+	double ns = nanoseconds(opt, estimate);
+
+	std::vector<std::complex<double>> root(BINS);
+	for (int n = 0; n < BINS; ++n)
+		root[n] = std::polar(1.0, -2 * M_PI * n / BINS);
+	std::vector<std::complex<double>> spectra(HALF * CHANNELS);
+	for (int c = 0; c < CHANNELS; ++c) {
+		for (int k = 0; k < HALF; ++k) {
+			std::complex<double> sum;
+			for (int n = 0; n < FRAME; ++n)
+				sum += double(in[FRAME * c + n]) * root[n * k % BINS];
+			spectra[HALF * c + k] = sum / std::abs(sum);
+		}
+	}
+	double delay_error = 0, peak_error = 0;
+	int wrong = 0, p = 0;
+	std::vector<double> r(2 * maxlag + 1);
+	for (int i = 0; i < CHANNELS; ++i) {
+		for (int j = i + 1; j < CHANNELS; ++j, ++p) {
+			int top = 0;
+			for (int l = 0; l <= 2 * maxlag; ++l) {
+				int n = (l - maxlag + BINS) % BINS;
+				double sum = 0;
+				for (int k = 0; k < BINS; ++k) {
+					std::complex<double> cross = k < HALF ? spectra[HALF * i + k] * std::conj(spectra[HALF * j + k]) : std::conj(spectra[HALF * i + BINS - k]) * spectra[HALF * j + BINS - k];
+					sum += (cross * std::conj(root[(long long)n * k % BINS])).real();
+				}
+				if ((r[l] = sum / BINS) > r[top])
+					top = l;
+			}
+			double a = top > 0 ? r[top - 1] : r[top], b = r[top], c = top < 2 * maxlag ? r[top + 1] : r[top], d = a - 2 * b + c;
+			double delta = d < 0 ? 0.5 * (a - c) / d : 0;
+			delay_error = std::max(delay_error, std::abs(delays[p] - (top - maxlag + delta)));
+			peak_error = std::max(peak_error, std::abs(peaks[p] - (b - 0.25 * (a - c) * delta)));
+			wrong += std::lround(delays[p]) != lag[i] - lag[j];
+		}
+	}
+
+	std::cerr << "correlate: " << std::setw(4) << BINS << " bins " << CHANNELS << " channels maxlag: " << std::setw(4) << maxlag;
+	std::cerr << " frames/s: " << std::setw(7) << std::lround(1e9 / ns) << " delay error: " << std::setw(11) << delay_error;
+	std::cerr << " peak error: " << std::setw(11) << peak_error << " wrong: " << wrong << " of " << PAIRS << std::endl;
+}
+
+static void features(const Options &opt)
+{
+	typedef Complex<double> complex_type;
+
+	split<64, complex_type>(opt);
+	split<256, complex_type>(opt);
+	split<1024, complex_type>(opt);
+	split<1920, complex_type>(opt);
+	split<4096, complex_type>(opt);
+
+	channelizer<64, 8, 1, complex_type>(opt);
+	channelizer<64, 8, 2, complex_type>(opt);
+	channelizer<256, 16, 2, complex_type>(opt);
+	channelizer<1024, 16, 2, complex_type>(opt);
+	channelizer<1024, 8, 2, complex_type>(opt);
+
+	resampler<1470, 1600, 32, complex_type>(opt);
+	resampler<1600, 1470, 32, complex_type>(opt);
+	resampler<1024, 512, 32, complex_type>(opt);
+	resampler<768, 1125, 32, complex_type>(opt);
+	resampler<1125, 768, 32, complex_type>(opt);
+
+	hilbert<1024, 63, complex_type>(opt);
+	hilbert<1024, 255, complex_type>(opt);
+	hilbert<4096, 1023, complex_type>(opt);
+
+	ntt<1024, complex_type>(opt);
+	ntt<16384, complex_type>(opt);
+	ntt<262144, complex_type>(opt);
+	ntt<1048576, complex_type>(opt);
+
+	fixed<64, complex_type>(opt);
+	fixed<256, complex_type>(opt);
+	fixed<1024, complex_type>(opt);
+	fixed<1920, complex_type>(opt);
+	fixed<4096, complex_type>(opt);
+
+	half<4096, Complex<float>>(opt);
+	half<65536, Complex<float>>(opt);
+	half<262144, Complex<float>>(opt);
+	half<1048576, Complex<float>>(opt);
+
+	cost<64, complex_type>();
+	cost<1000, complex_type>();
+	cost<1920, complex_type>();
+	cost<4096, complex_type>();
+	cost<65536, complex_type>();
+	cost<1048576, complex_type>();
+
+	planner<1920, Complex<float>>();
+	planner<2048, Complex<float>>();
+	planner<4096, Complex<float>>();
+	planner<1000, complex_type>();
+
+	radices<768, complex_type, 8, 8, 4, 3>(opt);
+	radices<768, complex_type, 3, 4, 8, 8>(opt);
+	radices<1920, complex_type, 5, 3, 2, 8, 8>(opt);
+	radices<1920, Complex<float>, 8, 8, 2, 3, 5>(opt);
+	radices<30, complex_type, 2, 3, 5>(opt);
+
+	pages<65536, Complex<float>>();
+	pages<262144, Complex<float>>();
+	pages<1048576, Complex<float>>();
+	pages<1048576, complex_type>();
+
+	ooc<4096, 4096, Complex<float>>();
+
+	peaks<1024, complex_type>(opt);
+	peaks<4096, Complex<float>>(opt);
+
+	multi<1, 64, 48, complex_type>(opt);
+	multi<3, 5, 8, complex_type>(opt);
+	multi<8, 16, 10, complex_type>(opt);
+	multi<16, 16, 16, Complex<float>>(opt);
+
+	dct<64, complex_type>(opt);
+	dct<1000, complex_type>(opt);
+	dct<1024, Complex<float>>(opt);
+
+	czt<1000, 200, complex_type>(opt);
+	czt<997, 64, complex_type>(opt);
+	czt<1024, 1024, Complex<float>>(opt);
+
+	correlate<1024, 4, complex_type>(opt, 32);
+	correlate<1024, 5, complex_type>(opt, 511);
+	correlate<4096, 3, Complex<float>>(opt, 100);
+}
+
+static void usage(const char *name)
+{
+	std::cerr << "usage: " << name << " [options]" << std::endl;
+	std::cerr << "  --sweep             time Forward for every listed size, the default" << std::endl;
+	std::cerr << "  --features          benchmark the split, channelizer, resampler, hilbert, ntt, fixed and half transforms, the cost model, the planner, explicit radices, huge pages, out of core, peaks, multidimensional, cosine and chirp z-transforms and correlation" << std::endl;
+	std::cerr << "  --min N, --max N    sizes of the sweep, default 1 to 1048576" << std::endl;
+	std::cerr << "  --type T            float or double, default both" << std::endl;
+	std::cerr << "  --complex C         own or std, default both" << std::endl;
+	std::cerr << "  --cache C           in or out, default both" << std::endl;
+	std::cerr << "  --trials N          batches timed per size, default 101" << std::endl;
+	std::cerr << "  --trial MS          shortest batch, default 1" << std::endl;
+	std::cerr << "  --warmup MS         warm up per size, default 20" << std::endl;
+	std::cerr << "  --budget MS         fewer trials for sizes taking longer, default 250" << std::endl;
+	std::cerr << "  --pool MIB          working set out of cache, default 64" << std::endl;
+	std::cerr << "  --repeat N          repeat the whole sweep, default 1" << std::endl;
+	std::cerr << "  --cpu N             pin to cpu N, -1 to not pin, default the current one" << std::endl;
+	std::cerr << "  --csv FILE          write the results as CSV" << std::endl;
+	std::cerr << "  --json FILE         write the results as JSON" << std::endl;
+	std::cerr << "  --plot              write float.txt and double.txt for gnuplot.txt" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	Options opt;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg(argv[i]);
+		if (arg == "--help") {
+			usage(argv[0]);
+			return 0;
+		}
+		if (arg == "--sweep") {
+			opt.sweep = true;
+			continue;
+		}
+		if (arg == "--features") {
+			opt.features = true;
+			continue;
+		}
+		if (arg == "--plot") {
+			opt.plot = true;
+			continue;
+		}
+		const char *value = ++i < argc ? argv[i] : 0;
+		bool valid = true;
+		if (!value)
+			valid = false;
+		else if (arg == "--min")
+			opt.min = std::atoi(value);
+		else if (arg == "--max")
+			opt.max = std::atoi(value);
+		else if (arg == "--type")
+			valid = (opt.single = !std::strcmp(value, "float")) | (opt.twice = !std::strcmp(value, "double"));
+		else if (arg == "--complex")
+			valid = (opt.own = !std::strcmp(value, "own")) | (opt.standard = !std::strcmp(value, "std"));
+		else if (arg == "--cache")
+			valid = (opt.in_cache = !std::strcmp(value, "in")) | (opt.out_of_cache = !std::strcmp(value, "out"));
+		else if (arg == "--trials")
+			valid = (opt.trials = std::atoi(value)) > 0;
+		else if (arg == "--trial")
+			opt.trial = std::atof(value) / 1000;
+		else if (arg == "--warmup")
+			opt.warmup = std::atof(value) / 1000;
+		else if (arg == "--budget")
+			opt.budget = std::atof(value) / 1000;
+		else if (arg == "--pool")
+			valid = (opt.pool = std::atoi(value)) > 0;
+		else if (arg == "--repeat")
+			valid = (opt.repeat = std::atoi(value)) > 0;
+		else if (arg == "--cpu")
+			opt.cpu = std::atoi(value);
+		else if (arg == "--csv")
+			opt.csv = value;
+		else if (arg == "--json")
+			opt.json = value;
+		else
+			valid = false;
+		if (!valid) {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (!opt.features || opt.plot)
+		opt.sweep = true;
+
+	pin(opt.cpu);
+
+	std::vector<Result> results;
+	// whole sweeps are repeated, so slow drifts spread over all sizes
+	for (int run = 0; opt.sweep && run < opt.repeat; ++run) {
+		size_t first = results.size();
+		if (opt.single && opt.own)
+			sweep<Complex<float>>(results, opt, sizes());
+		if (opt.twice && opt.own)
+			sweep<Complex<double>>(results, opt, sizes());
+		if (opt.single && opt.standard)
+			sweep<std::complex<float>>(results, opt, sizes());
+		if (opt.twice && opt.standard)
+			sweep<std::complex<double>>(results, opt, sizes());
+		for (size_t i = first; i < results.size(); ++i)
+			results[i].run = run;
+	}
+	if (opt.csv)
+		write_csv(opt.csv, results);
+	if (opt.json)
+		write_json(opt.json, results);
+	if (opt.plot)
+		write_plot(results);
+
+	if (opt.features)
+		features(opt);
+#ifdef FFT_PROFILE
+	FFT::Profile::report(std::cout);
+#endif
+}
@@ -0,0 +1,186 @@
+/*
+channelizer - polyphase filter bank channelizer and synthesizer
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef CHANNELIZER_HH
+#define CHANNELIZER_HH
+
+namespace FFT {
+
+/*
+Prototype low pass of CHANNELS * TAPS coefficients with unity gain at DC.
+Its magnitude response is the square root of a raised cosine that falls from
+one to zero between (1 - ROLLOFF) / 2 and (1 + ROLLOFF) / 2 channel spacings,
+so the squared responses of neighbouring channels add up to one.
+It is designed by frequency sampling and smoothed with a Blackman window.
+*/
+template <int CHANNELS, int TAPS, typename TYPE>
+class Prototype
+{
+	static const int LENGTH = CHANNELS * TAPS;
+	TYPE h[LENGTH];
+public:
+	Prototype(TYPE rolloff)
+	{
+		TYPE center = TYPE(LENGTH - 1) / TYPE(2), sum = 0;
+		for (int l = 0; l < LENGTH; ++l) {
+			TYPE t = TYPE(l) - center, sample = 0;
+			for (int k = 0; k <= LENGTH / 2; ++k) {
+				TYPE f = TYPE(k * CHANNELS) / TYPE(LENGTH), g = 0;
+				if (f <= (TYPE(1) - rolloff) / TYPE(2))
+					g = 1;
+				else if (f < (TYPE(1) + rolloff) / TYPE(2))
+					g = std::sqrt(TYPE(0.5) + TYPE(0.5) * std::cos(TYPE(M_PI) * (f - (TYPE(1) - rolloff) / TYPE(2)) / rolloff));
+				else
+					break;
+				sample += (k ? TYPE(2) : TYPE(1)) * g * std::cos(TYPE(2 * M_PI) * TYPE(k) * t / TYPE(LENGTH));
+			}
+			TYPE x = TYPE(2 * M_PI) * TYPE(l) / TYPE(LENGTH - 1);
+			sum += h[l] = sample * (TYPE(0.42) - TYPE(0.5) * std::cos(x) + TYPE(0.08) * std::cos(TYPE(2) * x));
+		}
+		for (int l = 0; l < LENGTH; ++l)
+			h[l] /= sum;
+	}
+	inline operator const TYPE * () const
+	{
+		return h;
+	}
+};
+
+/*
+Splits the input into CHANNELS equally spaced channels, channel k centered
+at k / CHANNELS times the input rate. Every call consumes STEP samples and
+produces one baseband sample per channel. OVERSAMPLE 1 is critically sampled,
+OVERSAMPLE 2 produces channels at twice their bandwidth, which also allows
+near perfect reconstruction with Synthesizer.
+The input is kept in a history twice the filter length, so the newest
+LENGTH samples are always contiguous. The polyphase branches are summed in
+one vectorizable pass and the commutator, including the rotation needed
+for oversampling, is folded into the loads of the fft.
+*/
+template <int CHANNELS, int TAPS, int OVERSAMPLE, typename TYPE>
+class Channelizer
+{
+public:
+	typedef typename TYPE::value_type value_type;
+	static const int LENGTH = CHANNELS * TAPS;
+	static const int STEP = CHANNELS / OVERSAMPLE;
+private:
+	static_assert(OVERSAMPLE == 1 || OVERSAMPLE == 2, "critically sampled or 2x oversampled");
+	static_assert(CHANNELS % OVERSAMPLE == 0, "channels have to be divisible by oversampling");
+	Backward<CHANNELS, TYPE> bwd;
+	value_type filter[LENGTH];
+	TYPE history[2 * LENGTH];
+	TYPE sum[CHANNELS];
+	int position, phase;
+public:
+	Channelizer(value_type rolloff = value_type(OVERSAMPLE == 1 ? 0.2 : 1)) : position(0), phase(STEP - 1)
+	{
+		Prototype<CHANNELS, TAPS, value_type> h(rolloff);
+		for (int l = 0; l < LENGTH; ++l)
+			filter[l] = h[LENGTH - 1 - l];
+		for (int l = 0; l < 2 * LENGTH; ++l)
+			history[l] = 0;
+	}
+	void operator ()(TYPE *out, const TYPE *in)
+	{
+		for (int n = 0; n < STEP; ++n) {
+			history[position] = history[position + LENGTH] = in[n];
+			if (++position == LENGTH)
+				position = 0;
+		}
+		const TYPE *x = history + position;
+		for (int c = 0; c < CHANNELS; ++c)
+			sum[c] = filter[c] * x[c];
+		for (int t = 1; t < TAPS; ++t)
+			for (int c = 0; c < CHANNELS; ++c)
+				sum[c] += filter[CHANNELS * t + c] * x[CHANNELS * t + c];
+		int shift = phase;
+		auto commutator = [&](int m) {
+			int i = m + shift;
+			return sum[CHANNELS - 1 - (i < CHANNELS ? i : i - CHANNELS)];
+		};
+		bwd(out, load(commutator));
+		phase = (phase + STEP) % CHANNELS;
+	}
+	// count outputs of CHANNELS samples from count * STEP input samples
+	void operator ()(TYPE *out, const TYPE *in, int count)
+	{
+		for (int i = 0; i < count; ++i)
+			(*this)(out + CHANNELS * i, in + STEP * i);
+	}
+};
+
+/*
+Inverse of Channelizer: every call takes one sample per channel and produces
+STEP output samples. The commutator rotation is folded into the stores of the
+fft and the polyphase branches are added into a ring buffer of overlapping
+outputs in one vectorizable pass. With OVERSAMPLE 2 and the default
+prototype the output matches the input of Channelizer delayed by
+LENGTH - STEP samples, to about -47dB with 8 taps and -63dB with 16 taps.
+Critically sampled, the aliasing between neighbouring channels does not cancel.
+*/
+template <int CHANNELS, int TAPS, int OVERSAMPLE, typename TYPE>
+class Synthesizer
+{
+public:
+	typedef typename TYPE::value_type value_type;
+	static const int LENGTH = CHANNELS * TAPS;
+	static const int STEP = CHANNELS / OVERSAMPLE;
+private:
+	static_assert(OVERSAMPLE == 1 || OVERSAMPLE == 2, "critically sampled or 2x oversampled");
+	static_assert(CHANNELS % OVERSAMPLE == 0, "channels have to be divisible by oversampling");
+	Backward<CHANNELS, TYPE> bwd;
+	value_type filter[LENGTH];
+	TYPE tmp[CHANNELS];
+	TYPE rotated[CHANNELS];
+	TYPE overlap[LENGTH];
+	int position, phase;
+public:
+	Synthesizer(value_type rolloff = value_type(OVERSAMPLE == 1 ? 0.2 : 1)) : position(0), phase(STEP % CHANNELS)
+	{
+		Prototype<CHANNELS, TAPS, value_type> h(rolloff);
+		for (int l = 0; l < LENGTH; ++l) {
+			filter[l] = value_type(STEP) * h[l];
+			overlap[l] = 0;
+		}
+	}
+	void operator ()(TYPE *out, const TYPE *in)
+	{
+		int shift = phase ? CHANNELS - phase : 0;
+		auto commutator = [&](int m, TYPE v) {
+			int j = m + shift;
+			rotated[j < CHANNELS ? j : j - CHANNELS] = v;
+		};
+		bwd(store(tmp, commutator), in);
+		for (int t = 0, l = position; t < TAPS; ++t, l += CHANNELS) {
+			if (l >= LENGTH)
+				l -= LENGTH;
+			int wrap = LENGTH - l < CHANNELS ? LENGTH - l : CHANNELS;
+			const value_type *f = filter + CHANNELS * t;
+			for (int c = 0; c < wrap; ++c)
+				overlap[l + c] += f[c] * rotated[c];
+			for (int c = wrap; c < CHANNELS; ++c)
+				overlap[l + c - LENGTH] += f[c] * rotated[c];
+		}
+		for (int n = 0; n < STEP; ++n) {
+			out[n] = overlap[position + n];
+			overlap[position + n] = 0;
+		}
+		if ((position += STEP) == LENGTH)
+			position = 0;
+		phase = (phase + STEP) % CHANNELS;
+	}
+	// count * STEP output samples from count inputs of CHANNELS samples
+	void operator ()(TYPE *out, const TYPE *in, int count)
+	{
+		for (int i = 0; i < count; ++i)
+			(*this)(out + STEP * i, in + CHANNELS * i);
+	}
+};
+
+}
+
+#endif
@@ -102,6 +102,12 @@ static inline Complex<T> operator / (Complex<T> a, Complex<T> b)
 			(a.imag() * b.real() - a.real() * b.imag()) / (b.real() * b.real() + b.imag() * b.imag()));
 }
 
+template <typename T>
+static inline Complex<T> conj(Complex<T> a)
+{
+	return Complex<T>(a.real(), -a.imag());
+}
+
 template <typename T>
 static inline Complex<T> exp(Complex<T> a)
 {
@@ -0,0 +1,136 @@
+/*
+correlate - generalized cross correlation with phase transform for all channel pairs
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef CORRELATE_HH
+#define CORRELATE_HH
+
+#include <limits>
+#include <vector>
+#include "memory.hh"
+#include "parallel.hh"
+
+namespace FFT {
+
+/*
+Estimates the delay between every pair of CHANNELS real channels with
+GCC-PHAT. Frames of FRAME = BINS / 2 samples are zero padded to BINS, so
+the correlation does not wrap.
+Each channel is transformed once, two channels packed into one Forward.
+Since PHAT divides the cross spectrum X_i conj(X_j) by its magnitude, the
+channel spectra are whitened once while they are separated and the cross
+spectrum of a pair is a single complex multiplication over the BINS / 2 + 1
+non redundant bins. The correlations are real, so two pairs share one
+Backward, their cross spectra packed into the real and imaginary part.
+The peak within +-maxlag is searched while the Backward stores and refined
+with a parabola through its neighbours. Channels and pairs are spread over
+the worker threads.
+*/
+template <int BINS, int CHANNELS, typename TYPE>
+class Correlator
+{
+public:
+	typedef typename TYPE::value_type value_type;
+	static const int FRAME = BINS / 2;
+	static const int HALF = BINS / 2 + 1;
+	static const int PAIRS = CHANNELS * (CHANNELS - 1) / 2;
+private:
+	static_assert(BINS % 2 == 0, "BINS has to be even");
+	static_assert(CHANNELS > 1, "need at least two channels");
+	Forward<BINS, TYPE> fwd;
+	Backward<BINS, TYPE> bwd;
+	Workers workers;
+	int maxlag;
+	Buffer<TYPE> spectra;
+	std::vector<int> first, second;
+	inline value_type refine(value_type *delay, const value_type *r, int peak) const
+	{
+		value_type a = peak > 0 ? r[peak - 1] : r[peak];
+		value_type b = r[peak];
+		value_type c = peak < 2 * maxlag ? r[peak + 1] : r[peak];
+		value_type d = a - value_type(2) * b + c;
+		value_type delta = d < value_type(0) ? value_type(0.5) * (a - c) / d : value_type(0);
+		*delay = value_type(peak - maxlag) + delta;
+		return b - value_type(0.25) * (a - c) * delta;
+	}
+public:
+	Correlator(int threads = 1, int maxlag = FRAME - 1) :
+		workers(threads), maxlag(maxlag < FRAME - 1 ? maxlag : FRAME - 1),
+		spectra(HALF * CHANNELS)
+	{
+		for (int i = 0; i < CHANNELS; ++i) {
+			for (int j = i + 1; j < CHANNELS; ++j) {
+				first.push_back(i);
+				second.push_back(j);
+			}
+		}
+	}
+	/*
+	Sample n of channel c is read from in[dist * c + stride * n].
+	delays[p] receives the delay in samples of channel i relative to channel j
+	for the pair p of i < j, enumerated as (0, 1), (0, 2) .. (1, 2) ..,
+	peaks[p], if given, the height of the correlation peak, 1 for a perfect match.
+	*/
+	template <typename SAMPLE>
+	void operator ()(value_type *delays, value_type *peaks, const SAMPLE *in, int stride = 1, int dist = FRAME)
+	{
+		value_type tiny = std::numeric_limits<value_type>::min();
+		workers((CHANNELS + 1) / 2, [&](int i, int) {
+			Scratch scratch;
+			int c = 2 * i;
+			const SAMPLE *x = in + dist * c, *y = c + 1 < CHANNELS ? x + dist : 0;
+			TYPE *z = scratch.get<TYPE>(BINS);
+			auto pack = [&](int n) { return n < FRAME ? TYPE(x[stride * n], y ? y[stride * n] : SAMPLE(0)) : TYPE(0); };
+			fwd(z, load(pack));
+			TYPE *X = spectra.data() + HALF * c, *Y = X + HALF;
+			for (int k = 0; k < HALF; ++k) {
+				TYPE p(z[k]), q(conj(z[(BINS - k) % BINS])), u(p + q), d(p - q), v(d.imag(), -d.real());
+				X[k] = u / (abs(u) + tiny);
+				if (y)
+					Y[k] = v / (abs(v) + tiny);
+			}
+		});
+		workers((PAIRS + 1) / 2, [&](int i, int) {
+			Scratch scratch;
+			int p = 2 * i, q = p + 1 < PAIRS ? p + 1 : -1;
+			const TYPE *A = spectra.data() + HALF * first[p], *B = spectra.data() + HALF * second[p];
+			const TYPE *C = q < 0 ? A : spectra.data() + HALF * first[q], *D = q < 0 ? B : spectra.data() + HALF * second[q];
+			TYPE *tmp = scratch.get<TYPE>(BINS), *cross = scratch.get<TYPE>(BINS);
+			value_type scale = value_type(1) / value_type(BINS);
+			for (int k = 0; k < HALF; ++k) {
+				TYPE r(scale * A[k] * conj(B[k])), s(scale * C[k] * conj(D[k]));
+				cross[k] = r + TYPE(-s.imag(), s.real());
+				if (k && k < BINS - k)
+					cross[BINS - k] = conj(r) + TYPE(s.imag(), s.real());
+			}
+			int width = 2 * maxlag + 1;
+			value_type *r = scratch.get<value_type>(2 * width), *s = r + width;
+			int rmax = 0, smax = 0;
+			value_type rtop = -std::numeric_limits<value_type>::max(), stop = rtop;
+			auto peak = [&](int n, TYPE v) {
+				int l = n <= maxlag ? n + maxlag : n - (BINS - maxlag);
+				if (l < 0)
+					return;
+				if ((r[l] = v.real()) > rtop)
+					rtop = r[rmax = l];
+				if ((s[l] = v.imag()) > stop)
+					stop = s[smax = l];
+			};
+			bwd(store(tmp, peak), cross);
+			value_type height = refine(delays + p, r, rmax);
+			if (peaks)
+				peaks[p] = height;
+			if (q >= 0) {
+				height = refine(delays + q, s, smax);
+				if (peaks)
+					peaks[q] = height;
+			}
+		});
+	}
+};
+
+}
+
+#endif
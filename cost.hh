@@ -0,0 +1,78 @@
+/*
+cost - operation counts and memory passes of a plan at compile time
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef COST_HH
+#define COST_HH
+
+namespace FFT {
+
+/*
+Real additions of one radix R kernel. The odd primes with h = (R - 1) / 2
+pair up the inputs with h sums and h twiddles, build h cosine and h sine
+sums of h constant products each, add up out0 and take two more additions
+for every other output.
+*/
+static constexpr long long kernel_adds(int R)
+{
+	return
+		R == 2 ? 4 :
+		R == 4 ? 16 :
+		R == 8 ? 64 :
+		6 * ((R - 1) / 2) + 4 * (R - 1) + 4 * ((R - 1) / 2) * ((R - 1) / 2 - 1);
+}
+
+// real multiplications of one radix R kernel: the cx and sx constants, the two rsqrt2 of radix 8
+static constexpr long long kernel_muls(int R)
+{
+	return
+		R == 2 || R == 4 ? 0 :
+		R == 8 ? 4 :
+		(R - 1) * (R - 1);
+}
+
+/*
+Counts of the recursion PLAN takes for BINS, the same plans as Chain takes,
+so Policy<0> is the order of Dit and split. Every stage but the leaves
+multiplies RADIX - 1 of its inputs with a twiddle factor loaded from the
+table, even the trivial ones of k = 0, as the butterfly loops do. Every
+stage touches all BINS values once, but the stages below a sub transform
+that fits into the cache do not go to memory again.
+*/
+template <typename PLAN, int BINS, int N = BINS, int RADIX = PLAN::template Next<N>::RADIX>
+struct Cost
+{
+	typedef Cost<typename PLAN::template Next<N>::REST, BINS, N / RADIX> Rest;
+	static const long long BUTTERFLIES = BINS / RADIX;
+	static const long long TWIDDLES = BUTTERFLIES * (RADIX - 1) + Rest::TWIDDLES;
+	static const long long ADDS = BUTTERFLIES * (kernel_adds(RADIX) + 2 * (RADIX - 1)) + Rest::ADDS;
+	static const long long MULS = BUTTERFLIES * (kernel_muls(RADIX) + 4 * (RADIX - 1)) + Rest::MULS;
+	static const long long FLOPS = ADDS + MULS;
+	static const int DEPTH = 1 + Rest::DEPTH;
+	// passes over memory with a cache of the given bytes for values of the given size
+	static constexpr int passes(long long cache, int size)
+	{
+		return N * (long long)size > cache ? 1 + Rest::passes(cache, size) : 1;
+	}
+};
+
+template <typename PLAN, int BINS, int RADIX>
+struct Cost<PLAN, BINS, RADIX, RADIX>
+{
+	static const long long BUTTERFLIES = BINS / RADIX;
+	static const long long TWIDDLES = 0;
+	static const long long ADDS = BUTTERFLIES * kernel_adds(RADIX);
+	static const long long MULS = BUTTERFLIES * kernel_muls(RADIX);
+	static const long long FLOPS = ADDS + MULS;
+	static const int DEPTH = 1;
+	static constexpr int passes(long long, int)
+	{
+		return 1;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*
+czt - chirp z-transform and zoom fft on top of the fft
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef CZT_HH
+#define CZT_HH
+
+#include "memory.hh"
+
+namespace FFT {
+
+static constexpr int fast_pow2(int N, int P)
+{
+	return P >= N ? P : fast_pow2(N, 2 * P);
+}
+
+static constexpr int fast_pow3(int N, int P)
+{
+	return P >= N ? P : fast_pow2(N, P) < fast_pow3(N, 3 * P) ? fast_pow2(N, P) : fast_pow3(N, 3 * P);
+}
+
+static constexpr int fast_pow5(int N, int P)
+{
+	return P >= N ? P : fast_pow3(N, P) < fast_pow5(N, 5 * P) ? fast_pow3(N, P) : fast_pow5(N, 5 * P);
+}
+
+// smallest size of the form 2^a 3^b 5^c not less than N
+static constexpr int fast(int N)
+{
+	return fast_pow5(N, 1);
+}
+
+/*
+Evaluates X[k] = sum x[n] A^-n W^nk for n < N and k < M, which are M points
+on the spiral A W^-k of the z-plane, with Bluestein's algorithm:
+X[k] = W^(k^2/2) sum (x[n] A^-n W^(n^2/2)) W^(-(k-n)^2/2)
+The convolution is done with a Forward and a Backward of LENGTH, the next
+fast size not less than N + M - 1. The chirps and the spectrum of the kernel
+are computed once per plan, the pre chirp is applied while the Forward loads,
+the kernel spectrum multiplied while it stores and the post chirp applied
+while the Backward stores, so only the spectrum of LENGTH is kept in between.
+*/
+template <int N, int M, typename TYPE>
+class ChirpZ
+{
+public:
+	typedef typename TYPE::value_type value_type;
+	static const int LENGTH = fast(N + M - 1);
+private:
+	Forward<LENGTH, TYPE> fwd;
+	Backward<LENGTH, TYPE> bwd;
+	TYPE kernel[LENGTH];
+	TYPE pre[N];
+	TYPE post[M];
+	static constexpr long double TAU = 6.283185307179586476925286766559L;
+	static TYPE power(long double radius, long double angle, long double exponent)
+	{
+		return exp(TYPE(value_type(radius * exponent), value_type(std::fmod(angle * exponent, TAU))));
+	}
+	void init(long double a_radius, long double a_angle, long double w_radius, long double w_angle)
+	{
+		for (int n = 0; n < N; ++n)
+			pre[n] = power(w_radius, w_angle, 0.5L * n * n) * power(a_radius, a_angle, -n);
+		for (int k = 0; k < M; ++k)
+			post[k] = power(w_radius, w_angle, 0.5L * k * k);
+		Scratch scratch;
+		TYPE *tmp = scratch.get<TYPE>(LENGTH);
+		for (int l = 0; l < LENGTH; ++l)
+			tmp[l] = 0;
+		for (int k = 0; k < M; ++k)
+			tmp[k] = power(w_radius, w_angle, -0.5L * k * k);
+		for (int n = 1; n < N; ++n)
+			tmp[LENGTH - n] = power(w_radius, w_angle, -0.5L * n * n);
+		fwd(kernel, tmp);
+		for (int l = 0; l < LENGTH; ++l)
+			kernel[l] /= value_type(LENGTH);
+	}
+public:
+	ChirpZ(TYPE A, TYPE W)
+	{
+		init(std::log(abs(A)), arg(A), std::log(abs(W)), arg(W));
+	}
+	// zoom fft: M points evenly spaced from f0 to f1 inclusive, given in the same unit as rate
+	ChirpZ(value_type f0, value_type f1, value_type rate)
+	{
+		long double step = (M > 1 ? ((long double)f1 - f0) / (M - 1) : 0) / rate;
+		init(0, TAU * f0 / rate, 0, -TAU * step);
+	}
+	template <typename OUT, typename IN>
+	void apply(OUT out, IN in)
+	{
+		Scratch scratch;
+		TYPE *tmp = scratch.get<TYPE>(LENGTH), *spec = scratch.get<TYPE>(LENGTH);
+		auto chirp = [&](int n) { return n < N ? pre[n] * TYPE(in(n)) : TYPE(0); };
+		auto convolve = [&](int k, TYPE v) { spec[k] = kernel[k] * v; };
+		auto dechirp = [&](int k, TYPE v) { if (k < M) out(k, post[k] * v); };
+		fwd(FFT::store(tmp, convolve), FFT::load(chirp));
+		bwd(FFT::store(tmp, dechirp), spec);
+	}
+	void operator ()(TYPE *out, const TYPE *in)
+	{
+		apply([=](int k, TYPE v) { out[k] = v; }, [=](int n) { return in[n]; });
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,291 @@
+/*
+dct - discrete cosine and sine transforms and mdct on top of the fft
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef DCT_HH
+#define DCT_HH
+
+#include "memory.hh"
+
+namespace FFT {
+
+/*
+Scaling follows FFTW: DCT2 computes y[k] = 2 sum x[n] cos(pi (n + 1/2) k / N),
+DCT3 is its inverse times 2N and so on for the others.
+Besides plain arrays the transforms take functors in(n) and out(k, y[k]),
+which the pre and post twiddles are fused with.
+*/
+template <int BINS, typename TYPE>
+class DCT2
+{
+public:
+	typedef typename TYPE::value_type value_type;
+private:
+	Forward<BINS, TYPE> fwd;
+	TYPE post[BINS];
+public:
+	DCT2()
+	{
+		for (int k = 0; k < BINS; ++k)
+			post[k] = value_type(2) * exp(TYPE(0, value_type(-M_PI) * value_type(k) / value_type(2 * BINS)));
+	}
+	template <typename OUT, typename IN>
+	void apply(OUT out, IN in)
+	{
+		auto load = [&](int n) { return TYPE(in(n < (BINS + 1) / 2 ? 2 * n : 2 * (BINS - n) - 1)); };
+		auto store = [&](int k, TYPE v) { out(k, (post[k] * v).real()); };
+		Scratch scratch;
+		fwd(FFT::store(scratch.get<TYPE>(BINS), store), FFT::load(load));
+	}
+	void operator ()(value_type *out, const value_type *in)
+	{
+		apply([=](int k, value_type v) { out[k] = v; }, [=](int n) { return in[n]; });
+	}
+};
+
+template <int BINS, typename TYPE>
+class DCT3
+{
+public:
+	typedef typename TYPE::value_type value_type;
+private:
+	Backward<BINS, TYPE> bwd;
+	TYPE pre[BINS];
+public:
+	DCT3()
+	{
+		for (int k = 0; k < BINS; ++k)
+			pre[k] = exp(TYPE(0, value_type(M_PI) * value_type(k) / value_type(2 * BINS)));
+	}
+	template <typename OUT, typename IN>
+	void apply(OUT out, IN in)
+	{
+		auto load = [&](int k) { return pre[k] * TYPE(in(k), k ? -in(BINS - k) : value_type(0)); };
+		auto store = [&](int n, TYPE v) { out(n < (BINS + 1) / 2 ? 2 * n : 2 * (BINS - n) - 1, v.real()); };
+		Scratch scratch;
+		bwd(FFT::store(scratch.get<TYPE>(BINS), store), FFT::load(load));
+	}
+	void operator ()(value_type *out, const value_type *in)
+	{
+		apply([=](int k, value_type v) { out[k] = v; }, [=](int n) { return in[n]; });
+	}
+};
+
+// uses a complex fft of half the size, BINS has to be even
+template <int BINS, typename TYPE>
+class DCT4
+{
+public:
+	typedef typename TYPE::value_type value_type;
+private:
+	static const int HALF = BINS / 2;
+	static_assert(BINS % 2 == 0, "DCT4 needs an even size");
+	Forward<HALF, TYPE> fwd;
+	TYPE pre[HALF], post[HALF];
+public:
+	DCT4()
+	{
+		for (int n = 0; n < HALF; ++n) {
+			pre[n] = exp(TYPE(0, value_type(-M_PI) * value_type(4 * n + 1) / value_type(4 * BINS)));
+			post[n] = value_type(2) * exp(TYPE(0, value_type(-M_PI) * value_type(n) / value_type(BINS)));
+		}
+	}
+	template <typename OUT, typename IN>
+	void apply(OUT out, IN in)
+	{
+		auto load = [&](int n) { return pre[n] * TYPE(in(2 * n), in(BINS - 1 - 2 * n)); };
+		auto store = [&](int k, TYPE v) {
+			TYPE u(post[k] * v);
+			out(2 * k, u.real());
+			out(BINS - 1 - 2 * k, -u.imag());
+		};
+		Scratch scratch;
+		fwd(FFT::store(scratch.get<TYPE>(HALF), store), FFT::load(load));
+	}
+	void operator ()(value_type *out, const value_type *in)
+	{
+		apply([=](int k, value_type v) { out[k] = v; }, [=](int n) { return in[n]; });
+	}
+};
+
+// DST2(x)[k] = DCT2((-1)^n x[n])[N - 1 - k]
+template <int BINS, typename TYPE>
+class DST2
+{
+	DCT2<BINS, TYPE> dct;
+public:
+	typedef typename TYPE::value_type value_type;
+	template <typename OUT, typename IN>
+	void apply(OUT out, IN in)
+	{
+		dct.apply([&](int k, value_type v) { out(BINS - 1 - k, v); }, [&](int n) { return n & 1 ? -in(n) : in(n); });
+	}
+	void operator ()(value_type *out, const value_type *in)
+	{
+		apply([=](int k, value_type v) { out[k] = v; }, [=](int n) { return in[n]; });
+	}
+};
+
+// DST3(x)[n] = (-1)^n DCT3(x[N - 1 - k])[n]
+template <int BINS, typename TYPE>
+class DST3
+{
+	DCT3<BINS, TYPE> dct;
+public:
+	typedef typename TYPE::value_type value_type;
+	template <typename OUT, typename IN>
+	void apply(OUT out, IN in)
+	{
+		dct.apply([&](int n, value_type v) { out(n, n & 1 ? -v : v); }, [&](int k) { return in(BINS - 1 - k); });
+	}
+	void operator ()(value_type *out, const value_type *in)
+	{
+		apply([=](int k, value_type v) { out[k] = v; }, [=](int n) { return in[n]; });
+	}
+};
+
+// DST4(x)[k] = (-1)^k DCT4(x[N - 1 - n])[k]
+template <int BINS, typename TYPE>
+class DST4
+{
+	DCT4<BINS, TYPE> dct;
+public:
+	typedef typename TYPE::value_type value_type;
+	template <typename OUT, typename IN>
+	void apply(OUT out, IN in)
+	{
+		dct.apply([&](int k, value_type v) { out(k, k & 1 ? -v : v); }, [&](int n) { return in(BINS - 1 - n); });
+	}
+	void operator ()(value_type *out, const value_type *in)
+	{
+		apply([=](int k, value_type v) { out[k] = v; }, [=](int n) { return in[n]; });
+	}
+};
+
+template <int BINS, typename TYPE>
+class SineWindow
+{
+	TYPE w[BINS];
+public:
+	SineWindow()
+	{
+		for (int n = 0; n < BINS; ++n)
+			w[n] = std::sin(TYPE(M_PI) * (TYPE(n) + TYPE(0.5)) / TYPE(BINS));
+	}
+	inline operator const TYPE * () const
+	{
+		return w;
+	}
+};
+
+/*
+Streaming MDCT: every call takes the next BINS samples and returns the BINS
+coefficients of the last 2 * BINS samples. Windowing and folding are done
+while the DCT4 loads its input, the window has to satisfy the Princen-Bradley
+condition w[n]^2 + w[n + BINS]^2 = 1 for IMDCT to cancel the time domain
+aliasing, a sine window is used by default.
+*/
+template <int BINS, typename TYPE>
+class MDCT
+{
+public:
+	typedef typename TYPE::value_type value_type;
+private:
+	DCT4<BINS, TYPE> dct;
+	value_type window[2 * BINS];
+	value_type prev[BINS];
+public:
+	MDCT()
+	{
+		SineWindow<2 * BINS, value_type> sine;
+		init(sine);
+	}
+	MDCT(const value_type *w)
+	{
+		init(w);
+	}
+	void init(const value_type *w)
+	{
+		for (int n = 0; n < 2 * BINS; ++n)
+			window[n] = w[n];
+		for (int n = 0; n < BINS; ++n)
+			prev[n] = 0;
+	}
+	void operator ()(value_type *out, const value_type *in)
+	{
+		auto z = [&](int n) { return window[n] * (n < BINS ? prev[n] : in[n - BINS]); };
+		auto fold = [&](int n) {
+			return n < BINS / 2 ?
+				-z(3 * BINS / 2 - 1 - n) - z(3 * BINS / 2 + n) :
+				z(n - BINS / 2) - z(3 * BINS / 2 - 1 - n);
+		};
+		dct.apply([&](int k, value_type v) { out[k] = value_type(0.5) * v; }, fold);
+		for (int n = 0; n < BINS; ++n)
+			prev[n] = in[n];
+	}
+};
+
+/*
+Streaming IMDCT: every call takes the BINS coefficients from MDCT and
+returns the next BINS samples, delayed by BINS samples to the input of MDCT.
+Unfolding, windowing and the overlap add are done while the DCT4 stores.
+*/
+template <int BINS, typename TYPE>
+class IMDCT
+{
+public:
+	typedef typename TYPE::value_type value_type;
+private:
+	DCT4<BINS, TYPE> dct;
+	value_type window[2 * BINS];
+	value_type overlap[2][BINS];
+	int current;
+public:
+	IMDCT()
+	{
+		SineWindow<2 * BINS, value_type> sine;
+		init(sine);
+	}
+	IMDCT(const value_type *w)
+	{
+		init(w);
+	}
+	void init(const value_type *w)
+	{
+		for (int n = 0; n < 2 * BINS; ++n)
+			window[n] = w[n];
+		for (int n = 0; n < BINS; ++n)
+			overlap[0][n] = overlap[1][n] = 0;
+		current = 0;
+	}
+	void operator ()(value_type *out, const value_type *in)
+	{
+		const value_type *old = overlap[current];
+		value_type *next = overlap[current ^ 1];
+		value_type scale = value_type(1) / value_type(BINS);
+		auto y = [&](int n, value_type v) {
+			if (n < BINS)
+				out[n] = old[n] + window[n] * v;
+			else
+				next[n - BINS] = window[n] * v;
+		};
+		auto unfold = [&](int k, value_type v) {
+			v *= scale;
+			if (k < BINS / 2) {
+				y(3 * BINS / 2 - 1 - k, -v);
+				y(3 * BINS / 2 + k, -v);
+			} else {
+				y(k - BINS / 2, v);
+				y(3 * BINS / 2 - 1 - k, -v);
+			}
+		};
+		dct.apply(unfold, [&](int k) { return in[k]; });
+		current ^= 1;
+	}
+};
+
+}
+
+#endif
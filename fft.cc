@@ -0,0 +1,454 @@
+/*
+fft - power spectra of raw IQ samples from a file or a pipe
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cerrno>
+#include <cstdint>
+#include <initializer_list>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "complex.hh"
+#include "fft.hh"
+#include "memory.hh"
+#include "parallel.hh"
+#include "spectrum.hh"
+
+// the samples are converted to Complex<float> while the first pass loads them
+struct Int16IQ
+{
+	int16_t re, im;
+	inline operator Complex<float> () const
+	{
+		return Complex<float>(float(re) * (1.0f / 32768), float(im) * (1.0f / 32768));
+	}
+};
+
+struct Uint8IQ
+{
+	uint8_t re, im;
+	inline operator Complex<float> () const
+	{
+		return Complex<float>((float(re) - 127.5f) * (1.0f / 128), (float(im) - 127.5f) * (1.0f / 128));
+	}
+};
+
+enum Format { CF32, CS16, CU8 };
+enum Average { MEAN, HOLD, DECAY };
+enum Window { HANN, HAMMING, BLACKMAN, RECT };
+
+struct Options
+{
+	int size = 1024, hop = 0, average = 1, threads = std::max(1U, std::thread::hardware_concurrency());
+	float alpha = 0;
+	Format format = CF32;
+	Average mode = MEAN;
+	Window window = HANN;
+	bool csv = false, db = false, shift = false, verbose = false;
+	const char *input = "-", *output = "-";
+};
+
+// names for messages, - stands for stdin or stdout
+static std::string stream_name(const char *name, const char *standard)
+{
+	return std::strcmp(name, "-") ? name : standard;
+}
+
+static const int SIZES[] = { 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536 };
+
+// index of value in names, -1 if not there
+static int lookup(const char *value, std::initializer_list<const char *> names)
+{
+	int index = 0;
+	for (const char *name : names) {
+		if (!std::strcmp(value, name))
+			return index;
+		++index;
+	}
+	return -1;
+}
+
+static std::vector<float> make_window(Window window, int bins)
+{
+	std::vector<float> w(bins);
+	for (int n = 0; n < bins; ++n) {
+		double x = 2 * M_PI * n / bins;
+		w[n] =
+			window == HANN ? 0.5 - 0.5 * std::cos(x) :
+			window == HAMMING ? 0.54 - 0.46 * std::cos(x) :
+			window == BLACKMAN ? 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2 * x) :
+			1;
+	}
+	return w;
+}
+
+/*
+Every spectrum is made of average frames hop samples apart, so spectrum s
+starts at sample s * average * hop. The spectra of a chunk are spread over
+the workers, and when there are fewer spectra than workers the frames of
+every spectrum are split into parts, each summed into a row of its own.
+*/
+template <int BINS, typename SAMPLE>
+class Spectra
+{
+	typedef Complex<float> TYPE;
+	FFT::Spectrum<BINS, TYPE> spectrum;
+	FFT::Workers workers;
+	const Options &opt;
+	FFT::Buffer<float> rows, parts, last;
+	bool started = false;
+	void frames(float *psd, const SAMPLE *in, int first, int count)
+	{
+		std::fill(psd, psd + BINS, 0.0f);
+		for (int f = first; f < first + count; ++f) {
+			if (opt.mode == HOLD)
+				spectrum.maxhold(psd, in + (long long)f * opt.hop);
+			else
+				spectrum.accumulate(psd, in + (long long)f * opt.hop);
+		}
+	}
+public:
+	Spectra(const float *window, const Options &opt) : spectrum(window), workers(opt.threads), opt(opt), last(BINS) {}
+	// samples of a whole spectrum
+	long long span() const
+	{
+		return (long long)(opt.average - 1) * opt.hop + BINS;
+	}
+	long long stride() const
+	{
+		return (long long)opt.average * opt.hop;
+	}
+	// the spectra that fit into samples, returns their number and their rows of BINS values
+	int operator ()(const float **result, const SAMPLE *in, long long samples, int most)
+	{
+		int count = samples < span() ? 0 : int(std::min<long long>(most, (samples - span()) / stride() + 1));
+		if (!count)
+			return 0;
+		rows.resize((size_t)count * BINS);
+		int split = count >= workers.size() ? 1 : std::min(opt.average, workers.size());
+		parts.resize(split > 1 ? (size_t)count * split * BINS : 0);
+		workers(count * split, [&](int item, int) {
+			int s = item / split, p = item % split;
+			int first = opt.average * p / split, next = opt.average * (p + 1) / split;
+			float *psd = split > 1 ? &parts[(size_t)item * BINS] : &rows[(size_t)s * BINS];
+			frames(psd, in + s * stride(), first, next - first);
+		});
+		for (int s = 0; s < count; ++s) {
+			float *row = &rows[(size_t)s * BINS];
+			for (int p = 0; split > 1 && p < split; ++p) {
+				const float *part = &parts[((size_t)s * split + p) * BINS];
+				for (int k = 0; k < BINS; ++k)
+					row[k] = !p ? part[k] : opt.mode == HOLD ? std::max(row[k], part[k]) : row[k] + part[k];
+			}
+			if (opt.mode != HOLD)
+				for (int k = 0; k < BINS; ++k)
+					row[k] *= 1.0f / opt.average;
+			if (opt.mode == DECAY) {
+				for (int k = 0; started && k < BINS; ++k)
+					row[k] = last[k] += opt.alpha * (row[k] - last[k]);
+				if (!started)
+					std::copy(row, row + BINS, last.begin());
+				started = true;
+			}
+		}
+		*result = rows.data();
+		return count;
+	}
+};
+
+class Writer
+{
+	FILE *file;
+	const Options &opt;
+	std::vector<float> values;
+	std::vector<char> text;
+	bool failed()
+	{
+		error = "writing " + stream_name(opt.output, "stdout") + ": " + (errno ? std::strerror(errno) : "short write");
+		return false;
+	}
+	bool put(const void *data, size_t size, size_t count)
+	{
+		errno = 0;
+		return fwrite(data, size, count, file) == count || failed();
+	}
+public:
+	// what went wrong when a call returned false
+	std::string error;
+	Writer(FILE *file, const Options &opt) : file(file), opt(opt), values(opt.size), text(16 * opt.size + 1) {}
+	bool flush()
+	{
+		errno = 0;
+		return !fflush(file) || failed();
+	}
+	bool operator ()(const float *rows, int count)
+	{
+		const int bins = opt.size;
+		for (int s = 0; s < count; ++s) {
+			const float *row = rows + (size_t)s * bins;
+			for (int k = 0; k < bins; ++k) {
+				float v = row[opt.shift ? (k + bins / 2) % bins : k];
+				values[k] = opt.db ? 10 * std::log10(std::max(v, 1e-30f)) : v;
+			}
+			if (!opt.csv) {
+				if (!put(values.data(), sizeof(float), bins))
+					return false;
+				continue;
+			}
+			char *end = text.data();
+			for (int k = 0; k < bins; ++k)
+				end += snprintf(end, 16, k ? ",%.6g" : "%.6g", values[k]);
+			*end++ = '\n';
+			if (!put(text.data(), 1, end - text.data()))
+				return false;
+		}
+		return true;
+	}
+};
+
+/*
+Regular files are mapped and read in place, announcing the next chunk to
+the kernel while the current one is transformed. Pipes are read into a
+large buffer, keeping the samples the next spectrum still needs. As soon as
+a read comes back short with a whole spectrum buffered, the spectra there
+are computed and flushed, so a slow stream gets them as they complete.
+*/
+template <int BINS, typename SAMPLE>
+static bool run(int fd, FILE *out, const Options &opt, long long *bytes, std::string *error)
+{
+	std::vector<float> window = make_window(opt.window, BINS);
+	Spectra<BINS, SAMPLE> engine(window.data(), opt);
+	Writer writer(out, opt);
+	const long long CHUNK = 32 << 20;
+	int most = int(std::max(1LL, std::min(CHUNK / (long long)sizeof(SAMPLE) / engine.stride(), 1LL << 20)));
+	const float *rows;
+	struct stat st;
+	if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void *map = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			madvise(map, st.st_size, MADV_SEQUENTIAL);
+			const SAMPLE *in = static_cast<const SAMPLE *>(map);
+			long long total = st.st_size / sizeof(SAMPLE), done = 0;
+			bool good = true;
+			for (int count; good && (count = engine(&rows, in + done, total - done, most)); done += count * engine.stride()) {
+				long long ahead = std::min(total, done + (long long)count * engine.stride());
+				long long page = ahead * sizeof(SAMPLE) & ~4095LL;
+				long long length = std::min<long long>(st.st_size - page, CHUNK + engine.span() * sizeof(SAMPLE));
+				if (length > 0)
+					madvise(static_cast<char *>(map) + page, length, MADV_WILLNEED);
+				good = writer(rows, count);
+			}
+			munmap(map, st.st_size);
+			*bytes = st.st_size;
+			*error = writer.error;
+			return good;
+		}
+	}
+	long long capacity = std::max(2 * CHUNK, 2 * engine.span() * (long long)sizeof(SAMPLE));
+	FFT::Buffer<char> buffer(capacity);
+	long long have = 0, skip = 0;
+	*bytes = 0;
+	for (bool end = false; !end;) {
+		while (have < capacity) {
+			long long want = capacity - have;
+			ssize_t got = read(fd, buffer.data() + have, want);
+			if (got < 0 && errno == EINTR)
+				continue;
+			if (got < 0) {
+				*error = "reading " + stream_name(opt.input, "stdin") + ": " + std::strerror(errno);
+				return false;
+			}
+			if (!got) {
+				end = true;
+				break;
+			}
+			*bytes += got;
+			long long drop = std::min<long long>(skip, got);
+			std::memmove(buffer.data() + have, buffer.data() + have + drop, got - drop);
+			skip -= drop;
+			have += got - drop;
+			if (got < want && have >= engine.span() * (long long)sizeof(SAMPLE))
+				break;
+		}
+		const SAMPLE *in = reinterpret_cast<const SAMPLE *>(buffer.data());
+		long long samples = have / sizeof(SAMPLE), done = 0;
+		for (int count; (count = engine(&rows, in + done, samples - done, most)); done += count * engine.stride()) {
+			if (!writer(rows, count)) {
+				*error = writer.error;
+				return false;
+			}
+		}
+		if (done && !writer.flush()) {
+			*error = writer.error;
+			return false;
+		}
+		long long used = std::min(done, samples) * sizeof(SAMPLE);
+		skip = std::max(0LL, done - samples) * sizeof(SAMPLE);
+		std::memmove(buffer.data(), buffer.data() + used, have - used);
+		have -= used;
+	}
+	return true;
+}
+
+template <int BINS>
+static bool format(int fd, FILE *out, const Options &opt, long long *bytes, std::string *error)
+{
+	if (opt.format == CS16)
+		return run<BINS, Int16IQ>(fd, out, opt, bytes, error);
+	if (opt.format == CU8)
+		return run<BINS, Uint8IQ>(fd, out, opt, bytes, error);
+	return run<BINS, Complex<float>>(fd, out, opt, bytes, error);
+}
+
+template <int BINS>
+static bool dispatch(int fd, FILE *out, const Options &opt, long long *bytes, std::string *error)
+{
+	if (opt.size == BINS)
+		return format<BINS>(fd, out, opt, bytes, error);
+	return dispatch<BINS * 2>(fd, out, opt, bytes, error);
+}
+
+template <>
+bool dispatch<131072>(int, FILE *, const Options &opt, long long *, std::string *error)
+{
+	*error = "unsupported size " + std::to_string(opt.size);
+	return false;
+}
+
+static void usage(const char *name)
+{
+	std::cerr << "usage: " << name << " [options] [INPUT]" << std::endl;
+	std::cerr << "  INPUT               raw interleaved IQ samples, - or none for stdin" << std::endl;
+	std::cerr << "  --format F          cf32, cs16 or cu8, default cf32" << std::endl;
+	std::cerr << "  --size N            power of two from 64 to 65536, default 1024" << std::endl;
+	std::cerr << "  --window W          hann, hamming, blackman or rect, default hann" << std::endl;
+	std::cerr << "  --hop N             samples between frames, default the size" << std::endl;
+	std::cerr << "  --average N         frames per spectrum, default 1" << std::endl;
+	std::cerr << "  --hold              max hold over the frames instead of their mean" << std::endl;
+	std::cerr << "  --decay ALPHA       exponential average of the spectra, 0 < ALPHA <= 1, not with --hold" << std::endl;
+	std::cerr << "  --threads N         worker threads, default all cpus" << std::endl;
+	std::cerr << "  --output FILE       - for stdout, the default" << std::endl;
+	std::cerr << "  --csv               a line of comma separated values per spectrum instead of float32 rows" << std::endl;
+	std::cerr << "  --db                10 log10 of the power" << std::endl;
+	std::cerr << "  --shift             the zero frequency in the middle" << std::endl;
+	std::cerr << "  --verbose           report the throughput to stderr" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	Options opt;
+	bool input = false;
+	int format = CF32, window = HANN;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg(argv[i]);
+		if (arg == "--help") {
+			usage(argv[0]);
+			return 0;
+		}
+		if (arg == "--hold") {
+			opt.mode = HOLD;
+			continue;
+		}
+		if (arg == "--csv" || arg == "--db" || arg == "--shift" || arg == "--verbose") {
+			opt.csv |= arg == "--csv";
+			opt.db |= arg == "--db";
+			opt.shift |= arg == "--shift";
+			opt.verbose |= arg == "--verbose";
+			continue;
+		}
+		if (arg.compare(0, 2, "--") || arg == "-") {
+			if (input) {
+				usage(argv[0]);
+				return 1;
+			}
+			input = true;
+			opt.input = argv[i];
+			continue;
+		}
+		const char *value = ++i < argc ? argv[i] : 0;
+		bool valid = true;
+		if (!value)
+			valid = false;
+		else if (arg == "--format")
+			valid = (format = lookup(value, { "cf32", "cs16", "cu8" })) >= 0;
+		else if (arg == "--size")
+			valid = std::count(std::begin(SIZES), std::end(SIZES), opt.size = std::atoi(value)) > 0;
+		else if (arg == "--window")
+			valid = (window = lookup(value, { "hann", "hamming", "blackman", "rect" })) >= 0;
+		else if (arg == "--hop")
+			valid = (opt.hop = std::atoi(value)) > 0;
+		else if (arg == "--average")
+			valid = (opt.average = std::atoi(value)) > 0;
+		else if (arg == "--decay")
+			valid = (opt.alpha = std::atof(value)) > 0 && opt.alpha <= 1;
+		else if (arg == "--threads")
+			valid = (opt.threads = std::atoi(value)) > 0;
+		else if (arg == "--output")
+			opt.output = value;
+		else
+			valid = false;
+		if (!valid) {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	opt.format = Format(format);
+	opt.window = Window(window);
+	if (!opt.hop)
+		opt.hop = opt.size;
+	if (opt.alpha > 0 && opt.mode == HOLD) {
+		std::cerr << argv[0] << ": --hold and --decay can not be combined" << std::endl;
+		return 1;
+	}
+	if (opt.alpha > 0)
+		opt.mode = DECAY;
+
+	int fd = std::strcmp(opt.input, "-") ? open(opt.input, O_RDONLY) : 0;
+	if (fd < 0) {
+		std::cerr << argv[0] << ": " << opt.input << ": " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+	FILE *out = std::strcmp(opt.output, "-") ? fopen(opt.output, "w") : stdout;
+	if (!out) {
+		std::cerr << argv[0] << ": " << opt.output << ": " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+	// outlives main, as stdout is flushed once more at exit
+	static std::vector<char> buffer(1 << 20);
+	setvbuf(out, buffer.data(), _IOFBF, buffer.size());
+
+	auto start = std::chrono::steady_clock::now();
+	long long bytes = 0;
+	std::string error;
+	bool done = dispatch<64>(fd, out, opt, &bytes, &error);
+	errno = 0;
+	bool flushed = !fflush(out);
+	if (out != stdout)
+		flushed = !fclose(out) && flushed;
+	if (!flushed && done) {
+		error = "writing " + stream_name(opt.output, "stdout") + ": " + (errno ? std::strerror(errno) : "short write");
+		done = false;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (!done)
+		std::cerr << argv[0] << ": " << error << std::endl;
+	if (fd)
+		close(fd);
+	if (opt.verbose)
+		std::cerr << bytes / 1e6 << " MB in " << seconds << " s, " << bytes / seconds / 1e6 << " MB/s" << std::endl;
+	return done ? 0 : 1;
+}
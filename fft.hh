@@ -8,6 +8,12 @@ You should have received a copy of the CC0 Public Domain Dedication along with t
 #ifndef FFT_HH
 #define FFT_HH
 
+#ifdef FFT_PROFILE
+#include "profile.hh"
+#else
+#define FFT_PROBE(RADIX, BINS, STRIDE, SIGN)
+#endif
+
 namespace FFT {
 
 template <typename TYPE>
@@ -16,16 +22,85 @@ static inline TYPE rsqrt2(TYPE a)
 	return (std::sqrt(typename TYPE::value_type(2)) / typename TYPE::value_type(2)) * a;
 }
 
+/*
+cos or sin of 2 pi n / N, reduced to the first octant with exact symmetries
+and computed in long double, so it only gets rounded once to the value type.
+*/
+static inline long double circle(int n, int N, bool sine)
+{
+	int m = (n % N + N) % N;
+	long double sign = 1;
+	if (2 * m > N) {
+		m = N - m;
+		if (sine)
+			sign = -sign;
+	}
+	// angle in units of pi / 2N
+	long long t = 4LL * m;
+	if (t > N) {
+		t = 2LL * N - t;
+		if (!sine)
+			sign = -sign;
+	}
+	if (2 * t > N) {
+		t = N - t;
+		sine = !sine;
+	}
+	long double x = 1.57079632679489661923132169163975144L * t / N;
+	return sign * (sine ? std::sin(x) : std::cos(x));
+}
+
+/*
+The same for the constants of the kernels, but evaluated by the compiler.
+Not every compiler folds the long double std::sin and std::cos of circle,
+clang leaves them as calls. The octant is summed as a Taylor series in
+Horner form instead, which is exact to long double up to pi / 4.
+*/
+static constexpr long double circle_taylor(long double xx, int i, int last)
+{
+	return i >= last ? 1 : 1 - xx / ((i + 1) * (i + 2)) * circle_taylor(xx, i + 2, last);
+}
+
+static constexpr long double circle_series(long double x, bool sine)
+{
+	return sine ? x * circle_taylor(x * x, 1, 27) : circle_taylor(x * x, 0, 26);
+}
+
+static constexpr long double circle_octant(long long t, int N, bool sine, long double sign)
+{
+	return 2 * t > N ? sign * circle_series(1.57079632679489661923132169163975144L * (N - t) / N, !sine) :
+		sign * circle_series(1.57079632679489661923132169163975144L * t / N, sine);
+}
+
+static constexpr long double circle_quadrant(long long t, int N, bool sine, long double sign)
+{
+	return t > N ? circle_octant(2LL * N - t, N, sine, sine ? sign : -sign) : circle_octant(t, N, sine, sign);
+}
+
+static constexpr long double circle_half(int m, int N, bool sine)
+{
+	return 2 * m > N ? circle_quadrant(4LL * (N - m), N, sine, sine ? -1 : 1) : circle_quadrant(4LL * m, N, sine, 1);
+}
+
+template <int n, int N, bool SINE>
+struct Circle
+{
+	static constexpr long double value = circle_half((n % N + N) % N, N, SINE);
+};
+
+template <int n, int N, bool SINE>
+constexpr long double Circle<n, N, SINE>::value;
+
 template <int n, int N, typename TYPE>
 static inline TYPE cx(TYPE a)
 {
-	return std::cos(typename TYPE::value_type(n * 2 * M_PI / N)) * a;
+	return typename TYPE::value_type(Circle<n, N, false>::value) * a;
 }
 
 template <int n, int N, typename TYPE>
 static inline TYPE sx(TYPE a)
 {
-	return std::sin(typename TYPE::value_type(n * 2 * M_PI / N)) * a;
+	return typename TYPE::value_type(Circle<n, N, true>::value) * a;
 }
 
 template <int n, int N, typename TYPE>
@@ -82,14 +157,22 @@ static constexpr int split(int N)
 		1;
 }
 
+template <typename OUT>
+static inline OUT scratch(OUT out)
+{
+	return out;
+}
+
 template <int RADIX, int BINS, int STRIDE, typename TYPE, int SIGN>
 struct Dit {};
 
 template <int STRIDE, typename TYPE, int SIGN>
 struct Dit<1, 1, STRIDE, TYPE, SIGN>
 {
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(1, 1, STRIDE, SIGN);
 		*out = *in;
 	}
 };
@@ -97,13 +180,16 @@ struct Dit<1, 1, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE, int SIGN>
 struct Dit<2, 2, STRIDE, TYPE, SIGN>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE in0, TYPE in1)
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, TYPE in0, TYPE in1)
 	{
 		*out0 = in0 + in1;
 		*out1 = in0 - in1;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(2, 2, STRIDE, SIGN);
 		dft(out, out + 1, in[0], in[STRIDE]);
 	}
 };
@@ -113,10 +199,12 @@ struct Dit<2, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 2;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(2, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, l1 = 0; k0 < QUOTIENT; ++k0, ++k1, l1 += STRIDE)
 			Dit<RADIX, RADIX, STRIDE, TYPE, SIGN>::dft(out + k0, out + k1, out[k0], z[l1] * out[k1]);
 	}
@@ -125,14 +213,17 @@ struct Dit<2, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<3, 3, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2,
 			TYPE in0, TYPE in1, TYPE in2)
 	{
 		Dit<3, 3, STRIDE, TYPE, 1>::dft(out0, out2, out1,
 			in0, in1, in2);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(3, 3, STRIDE, -1);
 		dft(out, out + 1, out + 2,
 			in[0], in[STRIDE], in[2 * STRIDE]);
 	}
@@ -141,7 +232,8 @@ struct Dit<3, 3, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<3, 3, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2,
 			TYPE in0, TYPE in1, TYPE in2)
 	{
 		TYPE a1(in1 + in2), t1(twiddle(in1, in2));
@@ -151,8 +243,10 @@ struct Dit<3, 3, STRIDE, TYPE, 1>
 		*out1 = in0 + c1 - s1;
 		*out2 = in0 + c1 + s1;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(3, 3, STRIDE, 1);
 		dft(out, out + 1, out + 2,
 			in[0], in[STRIDE], in[2 * STRIDE]);
 	}
@@ -163,10 +257,12 @@ struct Dit<3, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 3;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(3, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT,
 				l1 = 0, l2 = 0;
 				k0 < QUOTIENT;
@@ -180,14 +276,17 @@ struct Dit<3, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<4, 4, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3)
 	{
 		Dit<4, 4, STRIDE, TYPE, 1>::dft(out0, out3, out2, out1,
 			in0, in1, in2, in3);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(4, 4, STRIDE, -1);
 		dft(out, out + 1, out + 2, out + 3,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE]);
 	}
@@ -196,7 +295,8 @@ struct Dit<4, 4, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<4, 4, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3)
 	{
 		TYPE a(in0 + in2), b(in0 - in2);
@@ -206,8 +306,10 @@ struct Dit<4, 4, STRIDE, TYPE, 1>
 		*out2 = a - c;
 		*out3 = b + d;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(4, 4, STRIDE, 1);
 		dft(out, out + 1, out + 2, out + 3,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE]);
 	}
@@ -218,10 +320,12 @@ struct Dit<4, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 4;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(4, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT, k3 = 3 * QUOTIENT,
 				l1 = 0, l2 = 0, l3 = 0;
 				k0 < QUOTIENT;
@@ -235,14 +339,17 @@ struct Dit<4, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<5, 5, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4)
 	{
 		Dit<5, 5, STRIDE, TYPE, 1>::dft(out0, out4, out3, out2, out1,
 			in0, in1, in2, in3, in4);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(5, 5, STRIDE, -1);
 		dft(out, out + 1, out + 2, out + 3, out + 4,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE]);
 	}
@@ -251,7 +358,8 @@ struct Dit<5, 5, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<5, 5, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4)
 	{
 		TYPE a1(in1 + in4), t1(twiddle(in1, in4));
@@ -266,8 +374,10 @@ struct Dit<5, 5, STRIDE, TYPE, 1>
 		*out3 = in0 + c2 + s2;
 		*out4 = in0 + c1 + s1;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(5, 5, STRIDE, 1);
 		dft(out, out + 1, out + 2, out + 3, out + 4,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE]);
 	}
@@ -278,10 +388,12 @@ struct Dit<5, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 5;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(5, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT, k3 = 3 * QUOTIENT, k4 = 4 * QUOTIENT,
 				l1 = 0, l2 = 0, l3 = 0, l4 = 0;
 				k0 < QUOTIENT;
@@ -295,14 +407,17 @@ struct Dit<5, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<7, 7, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6)
 	{
 		Dit<7, 7, STRIDE, TYPE, 1>::dft(out0, out6, out5, out4, out3, out2, out1,
 			in0, in1, in2, in3, in4, in5, in6);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(7, 7, STRIDE, -1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE]);
 	}
@@ -311,7 +426,8 @@ struct Dit<7, 7, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<7, 7, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6)
 	{
 		TYPE a1(in1 + in6), t1(twiddle(in1, in6));
@@ -331,8 +447,10 @@ struct Dit<7, 7, STRIDE, TYPE, 1>
 		*out5 = in0 + c2 + s2;
 		*out6 = in0 + c1 + s1;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(7, 7, STRIDE, 1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE]);
 	}
@@ -343,10 +461,12 @@ struct Dit<7, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 7;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(7, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT, k3 = 3 * QUOTIENT, k4 = 4 * QUOTIENT, k5 = 5 * QUOTIENT, k6 = 6 * QUOTIENT,
 				l1 = 0, l2 = 0, l3 = 0, l4 = 0, l5 = 0, l6 = 0;
 				k0 < QUOTIENT;
@@ -360,14 +480,17 @@ struct Dit<7, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<8, 8, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7)
 	{
 		Dit<8, 8, STRIDE, TYPE, 1>::dft(out0, out7, out6, out5, out4, out3, out2, out1,
 			in0, in1, in2, in3, in4, in5, in6, in7);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(8, 8, STRIDE, -1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE]);
 	}
@@ -376,7 +499,8 @@ struct Dit<8, 8, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<8, 8, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7)
 	{
 		TYPE a(in0 + in4), b(in0 - in4);
@@ -394,8 +518,10 @@ struct Dit<8, 8, STRIDE, TYPE, 1>
 		*out6 = a - e + tcg;
 		*out7 = b + f + fdh;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(8, 8, STRIDE, 1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE]);
 	}
@@ -406,10 +532,12 @@ struct Dit<8, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 8;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(8, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT, k3 = 3 * QUOTIENT, k4 = 4 * QUOTIENT, k5 = 5 * QUOTIENT, k6 = 6 * QUOTIENT, k7 = 7 * QUOTIENT,
 				l1 = 0, l2 = 0, l3 = 0, l4 = 0, l5 = 0, l6 = 0, l7 = 0;
 				k0 < QUOTIENT;
@@ -423,14 +551,17 @@ struct Dit<8, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<11, 11, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10)
 	{
 		Dit<11, 11, STRIDE, TYPE, 1>::dft(out0, out10, out9, out8, out7, out6, out5, out4, out3, out2, out1,
 			in0, in1, in2, in3, in4, in5, in6, in7, in8, in9, in10);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(11, 11, STRIDE, -1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE]);
 	}
@@ -439,7 +570,8 @@ struct Dit<11, 11, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<11, 11, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10)
 	{
 		TYPE a1(in1 + in10), t1(twiddle(in1, in10));
@@ -469,8 +601,10 @@ struct Dit<11, 11, STRIDE, TYPE, 1>
 		*out9 = in0 + c2 + s2;
 		*out10 = in0 + c1 + s1;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(11, 11, STRIDE, 1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE]);
 	}
@@ -481,10 +615,12 @@ struct Dit<11, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 11;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(11, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT, k3 = 3 * QUOTIENT, k4 = 4 * QUOTIENT, k5 = 5 * QUOTIENT, k6 = 6 * QUOTIENT, k7 = 7 * QUOTIENT, k8 = 8 * QUOTIENT, k9 = 9 * QUOTIENT, k10 = 10 * QUOTIENT,
 				l1 = 0, l2 = 0, l3 = 0, l4 = 0, l5 = 0, l6 = 0, l7 = 0, l8 = 0, l9 = 0, l10 = 0;
 				k0 < QUOTIENT;
@@ -498,14 +634,17 @@ struct Dit<11, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<13, 13, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12)
 	{
 		Dit<13, 13, STRIDE, TYPE, 1>::dft(out0, out12, out11, out10, out9, out8, out7, out6, out5, out4, out3, out2, out1,
 			in0, in1, in2, in3, in4, in5, in6, in7, in8, in9, in10, in11, in12);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(13, 13, STRIDE, -1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE]);
 	}
@@ -514,7 +653,8 @@ struct Dit<13, 13, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<13, 13, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12)
 	{
 		TYPE a1(in1 + in12), t1(twiddle(in1, in12));
@@ -549,8 +689,10 @@ struct Dit<13, 13, STRIDE, TYPE, 1>
 		*out11 = in0 + c2 + s2;
 		*out12 = in0 + c1 + s1;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(13, 13, STRIDE, 1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE]);
 	}
@@ -561,10 +703,12 @@ struct Dit<13, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 13;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(13, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT, k3 = 3 * QUOTIENT, k4 = 4 * QUOTIENT, k5 = 5 * QUOTIENT, k6 = 6 * QUOTIENT, k7 = 7 * QUOTIENT, k8 = 8 * QUOTIENT, k9 = 9 * QUOTIENT, k10 = 10 * QUOTIENT, k11 = 11 * QUOTIENT, k12 = 12 * QUOTIENT,
 				l1 = 0, l2 = 0, l3 = 0, l4 = 0, l5 = 0, l6 = 0, l7 = 0, l8 = 0, l9 = 0, l10 = 0, l11 = 0, l12 = 0;
 				k0 < QUOTIENT;
@@ -578,14 +722,17 @@ struct Dit<13, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<17, 17, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12, TYPE *out13, TYPE *out14, TYPE *out15, TYPE *out16,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12, OUT out13, OUT out14, OUT out15, OUT out16,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12, TYPE in13, TYPE in14, TYPE in15, TYPE in16)
 	{
 		Dit<17, 17, STRIDE, TYPE, 1>::dft(out0, out16, out15, out14, out13, out12, out11, out10, out9, out8, out7, out6, out5, out4, out3, out2, out1,
 			in0, in1, in2, in3, in4, in5, in6, in7, in8, in9, in10, in11, in12, in13, in14, in15, in16);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(17, 17, STRIDE, -1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12, out + 13, out + 14, out + 15, out + 16,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE], in[13 * STRIDE], in[14 * STRIDE], in[15 * STRIDE], in[16 * STRIDE]);
 	}
@@ -594,7 +741,8 @@ struct Dit<17, 17, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<17, 17, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12, TYPE *out13, TYPE *out14, TYPE *out15, TYPE *out16,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12, OUT out13, OUT out14, OUT out15, OUT out16,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12, TYPE in13, TYPE in14, TYPE in15, TYPE in16)
 	{
 		TYPE a1(in1 + in16), t1(twiddle(in1, in16));
@@ -639,8 +787,10 @@ struct Dit<17, 17, STRIDE, TYPE, 1>
 		*out15 = in0 + c2 + s2;
 		*out16 = in0 + c1 + s1;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(17, 17, STRIDE, 1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12, out + 13, out + 14, out + 15, out + 16,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE], in[13 * STRIDE], in[14 * STRIDE], in[15 * STRIDE], in[16 * STRIDE]);
 	}
@@ -651,10 +801,12 @@ struct Dit<17, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 17;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(17, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT, k3 = 3 * QUOTIENT, k4 = 4 * QUOTIENT, k5 = 5 * QUOTIENT, k6 = 6 * QUOTIENT, k7 = 7 * QUOTIENT, k8 = 8 * QUOTIENT, k9 = 9 * QUOTIENT, k10 = 10 * QUOTIENT, k11 = 11 * QUOTIENT, k12 = 12 * QUOTIENT, k13 = 13 * QUOTIENT, k14 = 14 * QUOTIENT, k15 = 15 * QUOTIENT, k16 = 16 * QUOTIENT,
 				l1 = 0, l2 = 0, l3 = 0, l4 = 0, l5 = 0, l6 = 0, l7 = 0, l8 = 0, l9 = 0, l10 = 0, l11 = 0, l12 = 0, l13 = 0, l14 = 0, l15 = 0, l16 = 0;
 				k0 < QUOTIENT;
@@ -668,14 +820,17 @@ struct Dit<17, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<19, 19, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12, TYPE *out13, TYPE *out14, TYPE *out15, TYPE *out16, TYPE *out17, TYPE *out18,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12, OUT out13, OUT out14, OUT out15, OUT out16, OUT out17, OUT out18,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12, TYPE in13, TYPE in14, TYPE in15, TYPE in16, TYPE in17, TYPE in18)
 	{
 		Dit<19, 19, STRIDE, TYPE, 1>::dft(out0, out18, out17, out16, out15, out14, out13, out12, out11, out10, out9, out8, out7, out6, out5, out4, out3, out2, out1,
 			in0, in1, in2, in3, in4, in5, in6, in7, in8, in9, in10, in11, in12, in13, in14, in15, in16, in17, in18);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(19, 19, STRIDE, -1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12, out + 13, out + 14, out + 15, out + 16, out + 17, out + 18,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE], in[13 * STRIDE], in[14 * STRIDE], in[15 * STRIDE], in[16 * STRIDE], in[17 * STRIDE], in[18 * STRIDE]);
 	}
@@ -684,7 +839,8 @@ struct Dit<19, 19, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<19, 19, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12, TYPE *out13, TYPE *out14, TYPE *out15, TYPE *out16, TYPE *out17, TYPE *out18,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12, OUT out13, OUT out14, OUT out15, OUT out16, OUT out17, OUT out18,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12, TYPE in13, TYPE in14, TYPE in15, TYPE in16, TYPE in17, TYPE in18)
 	{
 		TYPE a1(in1 + in18), t1(twiddle(in1, in18));
@@ -734,8 +890,10 @@ struct Dit<19, 19, STRIDE, TYPE, 1>
 		*out17 = in0 + c2 + s2;
 		*out18 = in0 + c1 + s1;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(19, 19, STRIDE, 1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12, out + 13, out + 14, out + 15, out + 16, out + 17, out + 18,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE], in[13 * STRIDE], in[14 * STRIDE], in[15 * STRIDE], in[16 * STRIDE], in[17 * STRIDE], in[18 * STRIDE]);
 	}
@@ -746,10 +904,12 @@ struct Dit<19, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 19;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(19, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT, k3 = 3 * QUOTIENT, k4 = 4 * QUOTIENT, k5 = 5 * QUOTIENT, k6 = 6 * QUOTIENT, k7 = 7 * QUOTIENT, k8 = 8 * QUOTIENT, k9 = 9 * QUOTIENT, k10 = 10 * QUOTIENT, k11 = 11 * QUOTIENT, k12 = 12 * QUOTIENT, k13 = 13 * QUOTIENT, k14 = 14 * QUOTIENT, k15 = 15 * QUOTIENT, k16 = 16 * QUOTIENT, k17 = 17 * QUOTIENT, k18 = 18 * QUOTIENT,
 				l1 = 0, l2 = 0, l3 = 0, l4 = 0, l5 = 0, l6 = 0, l7 = 0, l8 = 0, l9 = 0, l10 = 0, l11 = 0, l12 = 0, l13 = 0, l14 = 0, l15 = 0, l16 = 0, l17 = 0, l18 = 0;
 				k0 < QUOTIENT;
@@ -763,14 +923,17 @@ struct Dit<19, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<23, 23, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12, TYPE *out13, TYPE *out14, TYPE *out15, TYPE *out16, TYPE *out17, TYPE *out18, TYPE *out19, TYPE *out20, TYPE *out21, TYPE *out22,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12, OUT out13, OUT out14, OUT out15, OUT out16, OUT out17, OUT out18, OUT out19, OUT out20, OUT out21, OUT out22,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12, TYPE in13, TYPE in14, TYPE in15, TYPE in16, TYPE in17, TYPE in18, TYPE in19, TYPE in20, TYPE in21, TYPE in22)
 	{
 		Dit<23, 23, STRIDE, TYPE, 1>::dft(out0, out22, out21, out20, out19, out18, out17, out16, out15, out14, out13, out12, out11, out10, out9, out8, out7, out6, out5, out4, out3, out2, out1,
 			in0, in1, in2, in3, in4, in5, in6, in7, in8, in9, in10, in11, in12, in13, in14, in15, in16, in17, in18, in19, in20, in21, in22);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(23, 23, STRIDE, -1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12, out + 13, out + 14, out + 15, out + 16, out + 17, out + 18, out + 19, out + 20, out + 21, out + 22,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE], in[13 * STRIDE], in[14 * STRIDE], in[15 * STRIDE], in[16 * STRIDE], in[17 * STRIDE], in[18 * STRIDE], in[19 * STRIDE], in[20 * STRIDE], in[21 * STRIDE], in[22 * STRIDE]);
 	}
@@ -779,7 +942,8 @@ struct Dit<23, 23, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<23, 23, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12, TYPE *out13, TYPE *out14, TYPE *out15, TYPE *out16, TYPE *out17, TYPE *out18, TYPE *out19, TYPE *out20, TYPE *out21, TYPE *out22,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12, OUT out13, OUT out14, OUT out15, OUT out16, OUT out17, OUT out18, OUT out19, OUT out20, OUT out21, OUT out22,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12, TYPE in13, TYPE in14, TYPE in15, TYPE in16, TYPE in17, TYPE in18, TYPE in19, TYPE in20, TYPE in21, TYPE in22)
 	{
 		TYPE a1(in1 + in22), t1(twiddle(in1, in22));
@@ -839,8 +1003,10 @@ struct Dit<23, 23, STRIDE, TYPE, 1>
 		*out21 = in0 + c2 + s2;
 		*out22 = in0 + c1 + s1;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(23, 23, STRIDE, 1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12, out + 13, out + 14, out + 15, out + 16, out + 17, out + 18, out + 19, out + 20, out + 21, out + 22,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE], in[13 * STRIDE], in[14 * STRIDE], in[15 * STRIDE], in[16 * STRIDE], in[17 * STRIDE], in[18 * STRIDE], in[19 * STRIDE], in[20 * STRIDE], in[21 * STRIDE], in[22 * STRIDE]);
 	}
@@ -851,10 +1017,12 @@ struct Dit<23, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 23;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(23, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT, k3 = 3 * QUOTIENT, k4 = 4 * QUOTIENT, k5 = 5 * QUOTIENT, k6 = 6 * QUOTIENT, k7 = 7 * QUOTIENT, k8 = 8 * QUOTIENT, k9 = 9 * QUOTIENT, k10 = 10 * QUOTIENT, k11 = 11 * QUOTIENT, k12 = 12 * QUOTIENT, k13 = 13 * QUOTIENT, k14 = 14 * QUOTIENT, k15 = 15 * QUOTIENT, k16 = 16 * QUOTIENT, k17 = 17 * QUOTIENT, k18 = 18 * QUOTIENT, k19 = 19 * QUOTIENT, k20 = 20 * QUOTIENT, k21 = 21 * QUOTIENT, k22 = 22 * QUOTIENT,
 				l1 = 0, l2 = 0, l3 = 0, l4 = 0, l5 = 0, l6 = 0, l7 = 0, l8 = 0, l9 = 0, l10 = 0, l11 = 0, l12 = 0, l13 = 0, l14 = 0, l15 = 0, l16 = 0, l17 = 0, l18 = 0, l19 = 0, l20 = 0, l21 = 0, l22 = 0;
 				k0 < QUOTIENT;
@@ -868,14 +1036,17 @@ struct Dit<23, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<29, 29, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12, TYPE *out13, TYPE *out14, TYPE *out15, TYPE *out16, TYPE *out17, TYPE *out18, TYPE *out19, TYPE *out20, TYPE *out21, TYPE *out22, TYPE *out23, TYPE *out24, TYPE *out25, TYPE *out26, TYPE *out27, TYPE *out28,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12, OUT out13, OUT out14, OUT out15, OUT out16, OUT out17, OUT out18, OUT out19, OUT out20, OUT out21, OUT out22, OUT out23, OUT out24, OUT out25, OUT out26, OUT out27, OUT out28,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12, TYPE in13, TYPE in14, TYPE in15, TYPE in16, TYPE in17, TYPE in18, TYPE in19, TYPE in20, TYPE in21, TYPE in22, TYPE in23, TYPE in24, TYPE in25, TYPE in26, TYPE in27, TYPE in28)
 	{
 		Dit<29, 29, STRIDE, TYPE, 1>::dft(out0, out28, out27, out26, out25, out24, out23, out22, out21, out20, out19, out18, out17, out16, out15, out14, out13, out12, out11, out10, out9, out8, out7, out6, out5, out4, out3, out2, out1,
 			in0, in1, in2, in3, in4, in5, in6, in7, in8, in9, in10, in11, in12, in13, in14, in15, in16, in17, in18, in19, in20, in21, in22, in23, in24, in25, in26, in27, in28);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(29, 29, STRIDE, -1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12, out + 13, out + 14, out + 15, out + 16, out + 17, out + 18, out + 19, out + 20, out + 21, out + 22, out + 23, out + 24, out + 25, out + 26, out + 27, out + 28,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE], in[13 * STRIDE], in[14 * STRIDE], in[15 * STRIDE], in[16 * STRIDE], in[17 * STRIDE], in[18 * STRIDE], in[19 * STRIDE], in[20 * STRIDE], in[21 * STRIDE], in[22 * STRIDE], in[23 * STRIDE], in[24 * STRIDE], in[25 * STRIDE], in[26 * STRIDE], in[27 * STRIDE], in[28 * STRIDE]);
 	}
@@ -884,7 +1055,8 @@ struct Dit<29, 29, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<29, 29, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12, TYPE *out13, TYPE *out14, TYPE *out15, TYPE *out16, TYPE *out17, TYPE *out18, TYPE *out19, TYPE *out20, TYPE *out21, TYPE *out22, TYPE *out23, TYPE *out24, TYPE *out25, TYPE *out26, TYPE *out27, TYPE *out28,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12, OUT out13, OUT out14, OUT out15, OUT out16, OUT out17, OUT out18, OUT out19, OUT out20, OUT out21, OUT out22, OUT out23, OUT out24, OUT out25, OUT out26, OUT out27, OUT out28,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12, TYPE in13, TYPE in14, TYPE in15, TYPE in16, TYPE in17, TYPE in18, TYPE in19, TYPE in20, TYPE in21, TYPE in22, TYPE in23, TYPE in24, TYPE in25, TYPE in26, TYPE in27, TYPE in28)
 	{
 		TYPE a1(in1 + in28), t1(twiddle(in1, in28));
@@ -959,8 +1131,10 @@ struct Dit<29, 29, STRIDE, TYPE, 1>
 		*out27 = in0 + c2 + s2;
 		*out28 = in0 + c1 + s1;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(29, 29, STRIDE, 1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12, out + 13, out + 14, out + 15, out + 16, out + 17, out + 18, out + 19, out + 20, out + 21, out + 22, out + 23, out + 24, out + 25, out + 26, out + 27, out + 28,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE], in[13 * STRIDE], in[14 * STRIDE], in[15 * STRIDE], in[16 * STRIDE], in[17 * STRIDE], in[18 * STRIDE], in[19 * STRIDE], in[20 * STRIDE], in[21 * STRIDE], in[22 * STRIDE], in[23 * STRIDE], in[24 * STRIDE], in[25 * STRIDE], in[26 * STRIDE], in[27 * STRIDE], in[28 * STRIDE]);
 	}
@@ -971,10 +1145,12 @@ struct Dit<29, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 29;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(29, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT, k3 = 3 * QUOTIENT, k4 = 4 * QUOTIENT, k5 = 5 * QUOTIENT, k6 = 6 * QUOTIENT, k7 = 7 * QUOTIENT, k8 = 8 * QUOTIENT, k9 = 9 * QUOTIENT, k10 = 10 * QUOTIENT, k11 = 11 * QUOTIENT, k12 = 12 * QUOTIENT, k13 = 13 * QUOTIENT, k14 = 14 * QUOTIENT, k15 = 15 * QUOTIENT, k16 = 16 * QUOTIENT, k17 = 17 * QUOTIENT, k18 = 18 * QUOTIENT, k19 = 19 * QUOTIENT, k20 = 20 * QUOTIENT, k21 = 21 * QUOTIENT, k22 = 22 * QUOTIENT, k23 = 23 * QUOTIENT, k24 = 24 * QUOTIENT, k25 = 25 * QUOTIENT, k26 = 26 * QUOTIENT, k27 = 27 * QUOTIENT, k28 = 28 * QUOTIENT,
 				l1 = 0, l2 = 0, l3 = 0, l4 = 0, l5 = 0, l6 = 0, l7 = 0, l8 = 0, l9 = 0, l10 = 0, l11 = 0, l12 = 0, l13 = 0, l14 = 0, l15 = 0, l16 = 0, l17 = 0, l18 = 0, l19 = 0, l20 = 0, l21 = 0, l22 = 0, l23 = 0, l24 = 0, l25 = 0, l26 = 0, l27 = 0, l28 = 0;
 				k0 < QUOTIENT;
@@ -988,14 +1164,17 @@ struct Dit<29, BINS, STRIDE, TYPE, SIGN>
 template <int STRIDE, typename TYPE>
 struct Dit<31, 31, STRIDE, TYPE, -1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12, TYPE *out13, TYPE *out14, TYPE *out15, TYPE *out16, TYPE *out17, TYPE *out18, TYPE *out19, TYPE *out20, TYPE *out21, TYPE *out22, TYPE *out23, TYPE *out24, TYPE *out25, TYPE *out26, TYPE *out27, TYPE *out28, TYPE *out29, TYPE *out30,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12, OUT out13, OUT out14, OUT out15, OUT out16, OUT out17, OUT out18, OUT out19, OUT out20, OUT out21, OUT out22, OUT out23, OUT out24, OUT out25, OUT out26, OUT out27, OUT out28, OUT out29, OUT out30,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12, TYPE in13, TYPE in14, TYPE in15, TYPE in16, TYPE in17, TYPE in18, TYPE in19, TYPE in20, TYPE in21, TYPE in22, TYPE in23, TYPE in24, TYPE in25, TYPE in26, TYPE in27, TYPE in28, TYPE in29, TYPE in30)
 	{
 		Dit<31, 31, STRIDE, TYPE, 1>::dft(out0, out30, out29, out28, out27, out26, out25, out24, out23, out22, out21, out20, out19, out18, out17, out16, out15, out14, out13, out12, out11, out10, out9, out8, out7, out6, out5, out4, out3, out2, out1,
 			in0, in1, in2, in3, in4, in5, in6, in7, in8, in9, in10, in11, in12, in13, in14, in15, in16, in17, in18, in19, in20, in21, in22, in23, in24, in25, in26, in27, in28, in29, in30);
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(31, 31, STRIDE, -1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12, out + 13, out + 14, out + 15, out + 16, out + 17, out + 18, out + 19, out + 20, out + 21, out + 22, out + 23, out + 24, out + 25, out + 26, out + 27, out + 28, out + 29, out + 30,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE], in[13 * STRIDE], in[14 * STRIDE], in[15 * STRIDE], in[16 * STRIDE], in[17 * STRIDE], in[18 * STRIDE], in[19 * STRIDE], in[20 * STRIDE], in[21 * STRIDE], in[22 * STRIDE], in[23 * STRIDE], in[24 * STRIDE], in[25 * STRIDE], in[26 * STRIDE], in[27 * STRIDE], in[28 * STRIDE], in[29 * STRIDE], in[30 * STRIDE]);
 	}
@@ -1004,7 +1183,8 @@ struct Dit<31, 31, STRIDE, TYPE, -1>
 template <int STRIDE, typename TYPE>
 struct Dit<31, 31, STRIDE, TYPE, 1>
 {
-	static inline void dft(TYPE *out0, TYPE *out1, TYPE *out2, TYPE *out3, TYPE *out4, TYPE *out5, TYPE *out6, TYPE *out7, TYPE *out8, TYPE *out9, TYPE *out10, TYPE *out11, TYPE *out12, TYPE *out13, TYPE *out14, TYPE *out15, TYPE *out16, TYPE *out17, TYPE *out18, TYPE *out19, TYPE *out20, TYPE *out21, TYPE *out22, TYPE *out23, TYPE *out24, TYPE *out25, TYPE *out26, TYPE *out27, TYPE *out28, TYPE *out29, TYPE *out30,
+	template <typename OUT>
+	static inline void dft(OUT out0, OUT out1, OUT out2, OUT out3, OUT out4, OUT out5, OUT out6, OUT out7, OUT out8, OUT out9, OUT out10, OUT out11, OUT out12, OUT out13, OUT out14, OUT out15, OUT out16, OUT out17, OUT out18, OUT out19, OUT out20, OUT out21, OUT out22, OUT out23, OUT out24, OUT out25, OUT out26, OUT out27, OUT out28, OUT out29, OUT out30,
 			TYPE in0, TYPE in1, TYPE in2, TYPE in3, TYPE in4, TYPE in5, TYPE in6, TYPE in7, TYPE in8, TYPE in9, TYPE in10, TYPE in11, TYPE in12, TYPE in13, TYPE in14, TYPE in15, TYPE in16, TYPE in17, TYPE in18, TYPE in19, TYPE in20, TYPE in21, TYPE in22, TYPE in23, TYPE in24, TYPE in25, TYPE in26, TYPE in27, TYPE in28, TYPE in29, TYPE in30)
 	{
 		TYPE a1(in1 + in30), t1(twiddle(in1, in30));
@@ -1084,8 +1264,10 @@ struct Dit<31, 31, STRIDE, TYPE, 1>
 		*out29 = in0 + c2 + s2;
 		*out30 = in0 + c1 + s1;
 	}
-	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *)
 	{
+		FFT_PROBE(31, 31, STRIDE, 1);
 		dft(out, out + 1, out + 2, out + 3, out + 4, out + 5, out + 6, out + 7, out + 8, out + 9, out + 10, out + 11, out + 12, out + 13, out + 14, out + 15, out + 16, out + 17, out + 18, out + 19, out + 20, out + 21, out + 22, out + 23, out + 24, out + 25, out + 26, out + 27, out + 28, out + 29, out + 30,
 			in[0], in[STRIDE], in[2 * STRIDE], in[3 * STRIDE], in[4 * STRIDE], in[5 * STRIDE], in[6 * STRIDE], in[7 * STRIDE], in[8 * STRIDE], in[9 * STRIDE], in[10 * STRIDE], in[11 * STRIDE], in[12 * STRIDE], in[13 * STRIDE], in[14 * STRIDE], in[15 * STRIDE], in[16 * STRIDE], in[17 * STRIDE], in[18 * STRIDE], in[19 * STRIDE], in[20 * STRIDE], in[21 * STRIDE], in[22 * STRIDE], in[23 * STRIDE], in[24 * STRIDE], in[25 * STRIDE], in[26 * STRIDE], in[27 * STRIDE], in[28 * STRIDE], in[29 * STRIDE], in[30 * STRIDE]);
 	}
@@ -1096,10 +1278,12 @@ struct Dit<31, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = 31;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE(31, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 		for (int k0 = 0, k1 = QUOTIENT, k2 = 2 * QUOTIENT, k3 = 3 * QUOTIENT, k4 = 4 * QUOTIENT, k5 = 5 * QUOTIENT, k6 = 6 * QUOTIENT, k7 = 7 * QUOTIENT, k8 = 8 * QUOTIENT, k9 = 9 * QUOTIENT, k10 = 10 * QUOTIENT, k11 = 11 * QUOTIENT, k12 = 12 * QUOTIENT, k13 = 13 * QUOTIENT, k14 = 14 * QUOTIENT, k15 = 15 * QUOTIENT, k16 = 16 * QUOTIENT, k17 = 17 * QUOTIENT, k18 = 18 * QUOTIENT, k19 = 19 * QUOTIENT, k20 = 20 * QUOTIENT, k21 = 21 * QUOTIENT, k22 = 22 * QUOTIENT, k23 = 23 * QUOTIENT, k24 = 24 * QUOTIENT, k25 = 25 * QUOTIENT, k26 = 26 * QUOTIENT, k27 = 27 * QUOTIENT, k28 = 28 * QUOTIENT, k29 = 29 * QUOTIENT, k30 = 30 * QUOTIENT,
 				l1 = 0, l2 = 0, l3 = 0, l4 = 0, l5 = 0, l6 = 0, l7 = 0, l8 = 0, l9 = 0, l10 = 0, l11 = 0, l12 = 0, l13 = 0, l14 = 0, l15 = 0, l16 = 0, l17 = 0, l18 = 0, l19 = 0, l20 = 0, l21 = 0, l22 = 0, l23 = 0, l24 = 0, l25 = 0, l26 = 0, l27 = 0, l28 = 0, l29 = 0, l30 = 0;
 				k0 < QUOTIENT;
@@ -1110,6 +1294,363 @@ struct Dit<31, BINS, STRIDE, TYPE, SIGN>
 	}
 };
 
+static constexpr int largest(int N)
+{
+	return
+		(!(N % 31)) ? 31 :
+		(!(N % 29)) ? 29 :
+		(!(N % 23)) ? 23 :
+		(!(N % 19)) ? 19 :
+		(!(N % 17)) ? 17 :
+		(!(N % 13)) ? 13 :
+		(!(N % 11)) ? 11 :
+		(!(N % 7)) ? 7 :
+		(!(N % 5)) ? 5 :
+		(!(N % 3)) ? 3 :
+		1;
+}
+
+static constexpr int smallest(int N)
+{
+	return
+		(!(N % 3)) ? 3 :
+		(!(N % 5)) ? 5 :
+		(!(N % 7)) ? 7 :
+		(!(N % 11)) ? 11 :
+		(!(N % 13)) ? 13 :
+		(!(N % 17)) ? 17 :
+		(!(N % 19)) ? 19 :
+		(!(N % 23)) ? 23 :
+		(!(N % 29)) ? 29 :
+		(!(N % 31)) ? 31 :
+		1;
+}
+
+// radix for the power of two part P: 0 like split, 1 fours, 2 eights below a single four or two
+static constexpr int twos(int P, int style)
+{
+	return
+		P < 2 ? 1 :
+		style == 1 ? (pow4(P) ? 4 : 2) :
+		style == 2 ? (pow8(P) ? 8 : pow8(P / 4) ? 4 : 2) :
+		(!(P % 8) && pow8(P)) ? 8 :
+		(!(P % 8) && pow8(P / 2)) ? 2 :
+		(!(P % 4) && pow4(P)) ? 4 :
+		2;
+}
+
+/*
+Radix of the first stage of N for one of the POLICIES orders of splitting.
+policy % 3 is the style of twos, policy / 3 % 2 takes the odd primes from
+the smallest up instead of the largest down, policy / 6 takes the power of
+two part first instead of last. Policy 0 is the order of split.
+*/
+static const int POLICIES = 12;
+
+static constexpr int factor(int N, int policy)
+{
+	return
+		(policy / 6 && !(N % 2)) || (N & -N) == N ?
+		twos(N & -N, policy % 3) :
+		policy / 3 % 2 ? smallest(N) : largest(N);
+}
+
+template <int... I>
+struct Indices {};
+
+template <int N, int... I>
+struct Sequence : Sequence<N - 1, N - 1, I...> {};
+
+template <int... I>
+struct Sequence<0, I...>
+{
+	typedef Indices<I...> type;
+};
+
+template <int POLICY>
+struct Policy
+{
+	template <int BINS>
+	struct Next
+	{
+		static const int RADIX = factor(BINS, POLICY);
+		typedef Policy<POLICY> REST;
+	};
+};
+
+static constexpr bool supported(int R)
+{
+	return R == 2 || R == 3 || R == 4 || R == 5 || R == 7 || R == 8 || R == 11 ||
+		R == 13 || R == 17 || R == 19 || R == 23 || R == 29 || R == 31;
+}
+
+/*
+Radix of every stage given explicitly, from the first stage to the leaves.
+radix(s) and stride(s) tell the radix and the input stride of stage s, the
+product of the radices before it.
+*/
+template <int... R>
+struct Radices;
+
+template <>
+struct Radices<>
+{
+	static const int PRODUCT = 1;
+	static const int STAGES = 0;
+	static constexpr int radix(int)
+	{
+		return 1;
+	}
+	static constexpr int stride(int)
+	{
+		return 1;
+	}
+};
+
+template <int R, int... RS>
+struct Radices<R, RS...>
+{
+	static_assert(supported(R), "unsupported radix");
+	static const int PRODUCT = R * Radices<RS...>::PRODUCT;
+	static const int STAGES = 1 + sizeof...(RS);
+	static constexpr int radix(int stage)
+	{
+		return stage ? Radices<RS...>::radix(stage - 1) : R;
+	}
+	static constexpr int stride(int stage)
+	{
+		return stage ? R * Radices<RS...>::stride(stage - 1) : 1;
+	}
+	template <int BINS>
+	struct Next
+	{
+		static_assert(BINS == PRODUCT, "radices have to multiply to BINS");
+		static const int RADIX = R;
+		typedef Radices<RS...> REST;
+	};
+};
+
+/*
+The same recursion as Dit, but PLAN::Next<BINS> decides the RADIX of each
+stage and the PLAN of the stages below, so the order of the factors can be
+chosen. The leaves and butterflies are the kernels of Dit.
+*/
+template <typename PLAN, int BINS, int STRIDE, typename TYPE, int SIGN, int RADIX = PLAN::template Next<BINS>::RADIX>
+struct Chain
+{
+	static_assert(RADIX > 1 && BINS % RADIX == 0, "unsupported factorization");
+	typedef typename PLAN::template Next<BINS>::REST REST;
+	static const int QUOTIENT = BINS / RADIX;
+	template <typename OUT, int... I>
+	static inline void butterfly(OUT out, const TYPE *z, int k, int l, Indices<0, I...>)
+	{
+		Dit<RADIX, RADIX, STRIDE, TYPE, SIGN>::dft(out + k, out + (k + I * QUOTIENT)...,
+			out[k], (z[I * l] * out[k + I * QUOTIENT])...);
+	}
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
+	{
+		FFT_PROBE(RADIX, BINS, STRIDE, SIGN);
+		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
+			Chain<REST, QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
+		for (int k = 0, l = 0; k < QUOTIENT; ++k, l += STRIDE)
+			butterfly(out, z, k, l, typename Sequence<RADIX>::type());
+	}
+};
+
+template <typename PLAN, int RADIX, int STRIDE, typename TYPE, int SIGN>
+struct Chain<PLAN, RADIX, STRIDE, TYPE, SIGN, RADIX>
+{
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *z)
+	{
+		Dit<RADIX, RADIX, STRIDE, TYPE, SIGN>::dit(out, in, z);
+	}
+};
+
+// the order of split is Dit itself, every other plan goes through Chain
+template <typename PLAN, int BINS, typename TYPE, int SIGN>
+struct Recursion
+{
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *z)
+	{
+		Chain<PLAN, BINS, 1, TYPE, SIGN>::dit(out, in, z);
+	}
+};
+
+template <int BINS, typename TYPE, int SIGN>
+struct Recursion<Policy<0>, BINS, TYPE, SIGN>
+{
+	template <typename OUT, typename IN>
+	static inline void dit(OUT out, IN in, const TYPE *z)
+	{
+		Dit<split(BINS), BINS, 1, TYPE, SIGN>::dit(out, in, z);
+	}
+};
+
+/*
+Dit reads its input through "in + n" and "in[n]" and writes its output
+through "out + n", "out[n]" and "*out", so besides plain pointers any type
+providing these can be used to reach data in place.
+*/
+template <typename TYPE>
+struct Strided
+{
+	TYPE *data;
+	int stride;
+	Strided(TYPE *data, int stride) : data(data), stride(stride) {}
+	inline Strided<TYPE> operator + (int n) const
+	{
+		return Strided<TYPE>(data + stride * n, stride);
+	}
+	inline TYPE &operator [] (int n) const
+	{
+		return data[stride * n];
+	}
+	inline TYPE &operator * () const
+	{
+		return *data;
+	}
+};
+
+/*
+Split complex data keeps the real and imaginary parts in separate arrays.
+Writes go through a small reference type, reads return TYPE by value.
+*/
+template <typename TYPE>
+struct Split
+{
+	typedef typename TYPE::value_type value_type;
+	struct Reference
+	{
+		value_type *re, *im;
+		inline Reference &operator = (TYPE a)
+		{
+			*re = a.real();
+			*im = a.imag();
+			return *this;
+		}
+		inline Reference &operator = (const Reference &a)
+		{
+			return *this = TYPE(a);
+		}
+		inline operator TYPE () const
+		{
+			return TYPE(*re, *im);
+		}
+	};
+	value_type *re, *im;
+	Split(value_type *re, value_type *im) : re(re), im(im) {}
+	inline Split<TYPE> operator + (int n) const
+	{
+		return Split<TYPE>(re + n, im + n);
+	}
+	inline TYPE operator [] (int n) const
+	{
+		return TYPE(re[n], im[n]);
+	}
+	inline Reference operator * () const
+	{
+		return Reference { re, im };
+	}
+};
+
+template <typename TYPE>
+struct Split<const TYPE>
+{
+	typedef typename TYPE::value_type value_type;
+	const value_type *re, *im;
+	Split(const value_type *re, const value_type *im) : re(re), im(im) {}
+	inline Split<const TYPE> operator + (int n) const
+	{
+		return Split<const TYPE>(re + n, im + n);
+	}
+	inline TYPE operator [] (int n) const
+	{
+		return TYPE(re[n], im[n]);
+	}
+	inline TYPE operator * () const
+	{
+		return TYPE(*re, *im);
+	}
+};
+
+/*
+Load calls func(n) for every input element n when it is first read by the
+leaf kernels. Store calls func(k, value) with every output element k from
+the last butterfly stage, while the stages before use tmp as work space.
+func may write to tmp[k], the last stage has already read it by then.
+*/
+template <typename FUNC>
+struct Load
+{
+	FUNC *func;
+	int offset;
+	Load(FUNC *func, int offset) : func(func), offset(offset) {}
+	inline Load<FUNC> operator + (int n) const
+	{
+		return Load<FUNC>(func, offset + n);
+	}
+	inline auto operator [] (int n) const -> decltype((*func)(n))
+	{
+		return (*func)(offset + n);
+	}
+	inline auto operator * () const -> decltype((*func)(0))
+	{
+		return (*func)(offset);
+	}
+};
+
+template <typename TYPE, typename FUNC>
+struct Store
+{
+	struct Reference
+	{
+		FUNC *func;
+		int offset;
+		inline Reference &operator = (TYPE a)
+		{
+			(*func)(offset, a);
+			return *this;
+		}
+	};
+	TYPE *tmp;
+	FUNC *func;
+	int offset;
+	Store(TYPE *tmp, FUNC *func, int offset) : tmp(tmp), func(func), offset(offset) {}
+	inline Store<TYPE, FUNC> operator + (int n) const
+	{
+		return Store<TYPE, FUNC>(tmp + n, func, offset + n);
+	}
+	inline TYPE operator [] (int n) const
+	{
+		return tmp[n];
+	}
+	inline Reference operator * () const
+	{
+		return Reference { func, offset };
+	}
+};
+
+template <typename TYPE, typename FUNC>
+static inline TYPE *scratch(Store<TYPE, FUNC> out)
+{
+	return out.tmp;
+}
+
+template <typename FUNC>
+static inline Load<FUNC> load(FUNC &func)
+{
+	return Load<FUNC>(&func, 0);
+}
+
+template <typename TYPE, typename FUNC>
+static inline Store<TYPE, FUNC> store(TYPE *tmp, FUNC &func)
+{
+	return Store<TYPE, FUNC>(tmp, &func, 0);
+}
+
 template <int BINS, typename TYPE, int SIGN>
 class Factors
 {
@@ -1119,7 +1660,7 @@ public:
 	Factors()
 	{
 		for (int n = 0; n < BINS; ++n)
-			z[n] = exp(TYPE(0, value_type(SIGN * 2 * M_PI) * value_type(n) / value_type(BINS)));
+			z[n] = TYPE(value_type(circle(SIGN * n, BINS, false)), value_type(circle(SIGN * n, BINS, true)));
 	}
 	inline operator const TYPE * () const
 	{
@@ -1127,7 +1668,7 @@ public:
 	}
 };
 
-template <int BINS, typename TYPE>
+template <int BINS, typename TYPE, typename PLAN = Policy<0>>
 class Forward
 {
 	Factors<BINS, TYPE, -1> factors;
@@ -1135,11 +1676,36 @@ public:
 	typedef typename TYPE::value_type value_type;
 	inline void operator ()(TYPE *out, const TYPE *in)
 	{
-		Dit<split(BINS), BINS, 1, TYPE, -1>::dit(out, in, factors);
+		Recursion<PLAN, BINS, TYPE, -1>::dit(out, in, factors);
+	}
+	template <typename OUT, typename IN>
+	inline void operator ()(OUT out, IN in)
+	{
+		Recursion<PLAN, BINS, TYPE, -1>::dit(out, in, factors);
+	}
+	void operator ()(TYPE *out, const TYPE *in, int ostride, int istride)
+	{
+		if (ostride == 1 && istride == 1)
+			(*this)(out, in);
+		else if (ostride == 1)
+			(*this)(out, Strided<const TYPE>(in, istride));
+		else if (istride == 1)
+			(*this)(Strided<TYPE>(out, ostride), in);
+		else
+			(*this)(Strided<TYPE>(out, ostride), Strided<const TYPE>(in, istride));
+	}
+	void operator ()(TYPE *out, const TYPE *in, int ostride, int istride, int count, int odist, int idist)
+	{
+		for (int n = 0; n < count; ++n)
+			(*this)(out + odist * n, in + idist * n, ostride, istride);
+	}
+	inline void operator ()(value_type *out_re, value_type *out_im, const value_type *in_re, const value_type *in_im)
+	{
+		Recursion<PLAN, BINS, TYPE, -1>::dit(Split<TYPE>(out_re, out_im), Split<const TYPE>(in_re, in_im), factors);
 	}
 };
 
-template <int BINS, typename TYPE>
+template <int BINS, typename TYPE, typename PLAN = Policy<0>>
 class Backward
 {
 	Factors<BINS, TYPE, 1> factors;
@@ -1147,8 +1713,45 @@ public:
 	typedef typename TYPE::value_type value_type;
 	inline void operator ()(TYPE *out, const TYPE *in)
 	{
-		Dit<split(BINS), BINS, 1, TYPE, 1>::dit(out, in, factors);
+		Recursion<PLAN, BINS, TYPE, 1>::dit(out, in, factors);
 	}
+	template <typename OUT, typename IN>
+	inline void operator ()(OUT out, IN in)
+	{
+		Recursion<PLAN, BINS, TYPE, 1>::dit(out, in, factors);
+	}
+	void operator ()(TYPE *out, const TYPE *in, int ostride, int istride)
+	{
+		if (ostride == 1 && istride == 1)
+			(*this)(out, in);
+		else if (ostride == 1)
+			(*this)(out, Strided<const TYPE>(in, istride));
+		else if (istride == 1)
+			(*this)(Strided<TYPE>(out, ostride), in);
+		else
+			(*this)(Strided<TYPE>(out, ostride), Strided<const TYPE>(in, istride));
+	}
+	void operator ()(TYPE *out, const TYPE *in, int ostride, int istride, int count, int odist, int idist)
+	{
+		for (int n = 0; n < count; ++n)
+			(*this)(out + odist * n, in + idist * n, ostride, istride);
+	}
+	inline void operator ()(value_type *out_re, value_type *out_im, const value_type *in_re, const value_type *in_im)
+	{
+		Recursion<PLAN, BINS, TYPE, 1>::dit(Split<TYPE>(out_re, out_im), Split<const TYPE>(in_re, in_im), factors);
+	}
+};
+
+template <int BINS, typename TYPE, int SIGN>
+struct Direction
+{
+	typedef Forward<BINS, TYPE> type;
+};
+
+template <int BINS, typename TYPE>
+struct Direction<BINS, TYPE, 1>
+{
+	typedef Backward<BINS, TYPE> type;
 };
 
 template <int BINS, typename TYPE>
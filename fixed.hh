@@ -0,0 +1,213 @@
+/*
+fixed - fixed point complex type and block floating point transforms
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef FIXED_HH
+#define FIXED_HH
+
+#include <cstdint>
+#include <type_traits>
+#include "memory.hh"
+
+namespace FFT {
+
+template <typename T>
+struct Wider {};
+
+template <>
+struct Wider<int16_t>
+{
+	typedef int32_t type;
+};
+
+template <>
+struct Wider<int32_t>
+{
+	typedef int64_t type;
+};
+
+/*
+Complex number with components in Q15 for int16_t or Q31 for int32_t.
+Additions, subtractions and negations are done in the unsigned type of the
+same width and wrap around modulo 2^BITS instead of overflowing, products
+with twiddles and constants are rounded in the next wider type. The radix kernels of fft.hh work unchanged, but
+they need log2(BINS) + 1 bits of headroom, which BlockFloat takes care of.
+*/
+template <typename T>
+class Fixed
+{
+	typedef typename Wider<T>::type W;
+	typedef typename std::make_unsigned<T>::type U;
+	T re, im;
+	static inline T add(T a, T b)
+	{
+		return T(U(U(a) + U(b)));
+	}
+	static inline T sub(T a, T b)
+	{
+		return T(U(U(a) - U(b)));
+	}
+public:
+	typedef T value_type;
+	static const int FRACTION = 8 * sizeof(T) - 1;
+	static const int BITS = 8 * sizeof(T);
+	Fixed() : re(0), im(0) {}
+	Fixed(T r, T i = 0) : re(r), im(i) {}
+	// closest representable value to a real number in [-1, 1]
+	static inline T quantize(double x)
+	{
+		double y = std::floor(x * double(W(1) << FRACTION) + 0.5);
+		return T(y < double((W(1) << FRACTION) - 1) ? y : double((W(1) << FRACTION) - 1));
+	}
+	static inline T multiply(T a, T b)
+	{
+		return T((W(a) * W(b) + (W(1) << (FRACTION - 1))) >> FRACTION);
+	}
+	inline T real() const
+	{
+		return re;
+	}
+	inline T imag() const
+	{
+		return im;
+	}
+	inline Fixed operator + (Fixed a) const
+	{
+		return Fixed(add(re, a.re), add(im, a.im));
+	}
+	inline Fixed operator - (Fixed a) const
+	{
+		return Fixed(sub(re, a.re), sub(im, a.im));
+	}
+	inline Fixed operator - () const
+	{
+		return Fixed(sub(0, re), sub(0, im));
+	}
+	inline Fixed operator * (Fixed a) const
+	{
+		return Fixed(
+			T((W(re) * W(a.re) - W(im) * W(a.im) + (W(1) << (FRACTION - 1))) >> FRACTION),
+			T((W(re) * W(a.im) + W(im) * W(a.re) + (W(1) << (FRACTION - 1))) >> FRACTION));
+	}
+	// real constant times a
+	friend inline Fixed operator * (T c, Fixed a)
+	{
+		return Fixed(multiply(c, a.re), multiply(c, a.im));
+	}
+	inline Fixed operator += (Fixed a)
+	{
+		return *this = *this + a;
+	}
+	inline Fixed operator -= (Fixed a)
+	{
+		return *this = *this - a;
+	}
+};
+
+template <typename T>
+static inline Fixed<T> rsqrt2(Fixed<T> a)
+{
+	return Fixed<T>::quantize(std::sqrt(0.5)) * a;
+}
+
+template <int n, int N, typename T>
+static inline Fixed<T> cx(Fixed<T> a)
+{
+	return Fixed<T>::quantize(std::cos(n * 2 * M_PI / N)) * a;
+}
+
+template <int n, int N, typename T>
+static inline Fixed<T> sx(Fixed<T> a)
+{
+	return Fixed<T>::quantize(std::sin(n * 2 * M_PI / N)) * a;
+}
+
+template <int BINS, typename T, int SIGN>
+class Factors<BINS, Fixed<T>, SIGN>
+{
+	Fixed<T> z[BINS];
+public:
+	Factors()
+	{
+		for (int n = 0; n < BINS; ++n)
+			z[n] = Fixed<T>(Fixed<T>::quantize(std::cos(2 * M_PI * n / BINS)), Fixed<T>::quantize(SIGN * std::sin(2 * M_PI * n / BINS)));
+	}
+	inline operator const Fixed<T> * () const
+	{
+		return z;
+	}
+};
+
+/*
+Block floating point transform computed in TYPE, Fixed<int16_t> or
+Fixed<int32_t>, from and to arrays of Fixed<int16_t> or Fixed<int32_t>.
+The input is shifted while it is loaded so its largest component leaves
+exactly the log2(BINS) + 1 bits of headroom the transform can grow by,
+small signals are shifted up instead of losing bits. The result is
+normalized to the full range of the output type. Returns the exponent e
+with out * 2^e being the unscaled transform of in.
+Computing in Fixed<int16_t> leaves only 15 - log2(BINS) - 1 bits for the
+signal, which is fine for short transforms. Computing in Fixed<int32_t>
+keeps all bits of int16_t samples at the cost of twice the scratch memory.
+*/
+template <int BINS, typename TYPE, int SIGN>
+class BlockFloat
+{
+	typedef typename TYPE::value_type value_type;
+	static constexpr int log2(int N)
+	{
+		return N > 1 ? 1 + log2((N + 1) / 2) : 0;
+	}
+	static const int HEADROOM = log2(BINS) + 1;
+	typename Direction<BINS, TYPE, SIGN>::type fft;
+	// bits needed besides the sign by all components
+	template <typename T>
+	static int width(const Fixed<T> *a)
+	{
+		int64_t bits = 0;
+		for (int n = 0; n < BINS; ++n) {
+			int64_t re = a[n].real(), im = a[n].imag();
+			bits |= (re < 0 ? ~re : re) | (im < 0 ? ~im : im);
+		}
+		int w = 0;
+		for (; bits; bits >>= 1)
+			++w;
+		return w;
+	}
+	// a * 2^s rounded and saturated
+	template <typename T>
+	static inline T shift(int64_t a, int s)
+	{
+		const int64_t hi = (int64_t(1) << (8 * sizeof(T) - 1)) - 1;
+		int64_t b = s >= 0 ? a * (int64_t(1) << s) : (a + (int64_t(1) << (-s - 1))) >> -s;
+		return T(b < -hi - 1 ? -hi - 1 : b > hi ? hi : b);
+	}
+public:
+	template <typename OUT, typename IN>
+	int operator ()(Fixed<OUT> *out, const Fixed<IN> *in)
+	{
+		int top = width(in);
+		int s = top ? TYPE::BITS - 1 - HEADROOM - top : 0;
+		auto normalize = [&](int n) { return TYPE(shift<value_type>(in[n].real(), s), shift<value_type>(in[n].imag(), s)); };
+		Scratch scratch;
+		TYPE *tmp = scratch.get<TYPE>(BINS);
+		fft(tmp, load(normalize));
+		top = width(tmp);
+		int t = top ? Fixed<OUT>::BITS - 1 - top : 0;
+		for (int n = 0; n < BINS; ++n)
+			out[n] = Fixed<OUT>(shift<OUT>(tmp[n].real(), t), shift<OUT>(tmp[n].imag(), t));
+		return -s - t;
+	}
+};
+
+template <int BINS, typename TYPE>
+class FixedForward : public BlockFloat<BINS, TYPE, -1> {};
+
+template <int BINS, typename TYPE>
+class FixedBackward : public BlockFloat<BINS, TYPE, 1> {};
+
+}
+
+#endif
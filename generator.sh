@@ -6,6 +6,7 @@
 RADIX=$1
 
 struct_header() {
+	DIRECTION=$1
 	cat << EOF
 template <int STRIDE, typename TYPE>
 struct Dit<$RADIX, $RADIX, STRIDE, TYPE, $1>
@@ -14,8 +15,10 @@ EOF
 }
 
 struct_footer() {
-	echo "	static inline void dit(TYPE *out, const TYPE *in, const TYPE *)"
+	echo "	template <typename OUT, typename IN>"
+	echo "	static inline void dit(OUT out, IN in, const TYPE *)"
 	echo "	{"
+	echo "		FFT_PROBE($RADIX, $RADIX, STRIDE, $DIRECTION);"
 	echo -n "		dft(out,"
 	for ((x = 1; x < RADIX; x++)) ; do
 		echo -n " out + $x,"
@@ -32,9 +35,10 @@ struct_footer() {
 }
 
 dft_header() {
-	echo -n "	static inline void dft(TYPE *out0,"
+	echo "	template <typename OUT>"
+	echo -n "	static inline void dft(OUT out0,"
 	for ((x = 1; x < RADIX; x++)) ; do
-		echo -n " TYPE *out$x,"
+		echo -n " OUT out$x,"
 	done
 	echo
 	echo -n "			"
@@ -115,10 +119,12 @@ struct Dit<$RADIX, BINS, STRIDE, TYPE, SIGN>
 {
 	static const int RADIX = $RADIX;
 	static const int QUOTIENT = BINS / RADIX;
-	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	template <typename OUT, typename IN>
+	static void dit(OUT out, IN in, const TYPE *z)
 	{
+		FFT_PROBE($RADIX, BINS, STRIDE, SIGN);
 		for (int o = 0, i = 0; o < BINS; o += QUOTIENT, i += STRIDE)
-			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(out + o, in + i, z);
+			Dit<split(QUOTIENT), QUOTIENT, RADIX * STRIDE, TYPE, SIGN>::dit(scratch(out) + o, in + i, z);
 EOF
 
 echo -n "		for (int k0 = 0, k1 = QUOTIENT,"
@@ -0,0 +1,140 @@
+/*
+half - half precision and bfloat16 storage for transforms computed in float
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef HALF_HH
+#define HALF_HH
+
+#include <cstdint>
+#include <cstring>
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+#include "memory.hh"
+
+namespace FFT {
+
+// IEEE 754 binary16, rounded to nearest even
+class Half
+{
+	uint16_t bits;
+	static inline uint32_t word(float f)
+	{
+		uint32_t x;
+		std::memcpy(&x, &f, sizeof(x));
+		return x;
+	}
+	static inline float real(uint32_t x)
+	{
+		float f;
+		std::memcpy(&f, &x, sizeof(f));
+		return f;
+	}
+public:
+	Half() : bits(0) {}
+	Half(float f)
+	{
+#ifdef __F16C__
+		bits = _cvtss_sh(f, 0);
+#else
+		uint32_t x = word(f), sign = (x >> 16) & 0x8000, a = x & 0x7fffffff;
+		if (a >= 0x7f800000)
+			bits = sign | 0x7c00 | (a > 0x7f800000 ? 0x200 | ((a >> 13) & 0x3ff) : 0);
+		else if (a >= 0x477ff000)
+			bits = sign | 0x7c00;
+		else if (a < 0x38800000)
+			bits = sign | (word(real(a) + 0.5f) - 0x3f000000);
+		else
+			bits = sign | ((a + 0xc8000fff + ((a >> 13) & 1)) >> 13);
+#endif
+	}
+	inline operator float () const
+	{
+#ifdef __F16C__
+		return _cvtsh_ss(bits);
+#else
+		uint32_t sign = uint32_t(bits & 0x8000) << 16, exp = (bits >> 10) & 0x1f, mant = bits & 0x3ff;
+		if (!exp)
+			return real(sign | word(float(mant) * 5.9604644775390625e-8f));
+		if (exp == 31)
+			return real(sign | 0x7f800000 | (mant ? 0x400000 | mant << 13 : 0));
+		return real(sign | ((exp + 112) << 23) | (mant << 13));
+#endif
+	}
+};
+
+// upper half of a float, rounded to nearest even
+class BFloat16
+{
+	uint16_t bits;
+public:
+	BFloat16() : bits(0) {}
+	BFloat16(float f)
+	{
+		uint32_t x;
+		std::memcpy(&x, &f, sizeof(x));
+		if ((x & 0x7fffffff) > 0x7f800000)
+			bits = (x >> 16) | 0x40;
+		else
+			bits = (x + 0x7fff + ((x >> 16) & 1)) >> 16;
+	}
+	inline operator float () const
+	{
+		uint32_t x = uint32_t(bits) << 16;
+		float f;
+		std::memcpy(&f, &x, sizeof(f));
+		return f;
+	}
+};
+
+// complex storage only, the arithmetic is done after loading into a wider type
+template <typename T>
+class Complex16
+{
+	T re, im;
+public:
+	Complex16() {}
+	Complex16(float r, float i = 0) : re(r), im(i) {}
+	inline float real() const
+	{
+		return re;
+	}
+	inline float imag() const
+	{
+		return im;
+	}
+};
+
+/*
+Transforms arrays of Complex16<Half> or Complex16<BFloat16>, computing in
+TYPE, usually Complex<float>. The samples are converted while the leaf
+kernels load them and the results while the last butterfly stage stores
+them, so nothing but the scratch of the transform is ever held in TYPE.
+*/
+template <int BINS, typename TYPE, int SIGN>
+class Widen
+{
+	typedef typename TYPE::value_type value_type;
+	typename Direction<BINS, TYPE, SIGN>::type fft;
+public:
+	template <typename OUT, typename IN>
+	void operator ()(Complex16<OUT> *out, const Complex16<IN> *in)
+	{
+		auto widen = [=](int n) { return TYPE(value_type(in[n].real()), value_type(in[n].imag())); };
+		auto narrow = [=](int k, TYPE v) { out[k] = Complex16<OUT>(float(v.real()), float(v.imag())); };
+		Scratch scratch;
+		fft(store(scratch.get<TYPE>(BINS), narrow), load(widen));
+	}
+};
+
+template <int BINS, typename TYPE>
+class HalfForward : public Widen<BINS, TYPE, -1> {};
+
+template <int BINS, typename TYPE>
+class HalfBackward : public Widen<BINS, TYPE, 1> {};
+
+}
+
+#endif
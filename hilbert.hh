@@ -0,0 +1,83 @@
+/*
+hilbert - hilbert transformer and analytic signal with overlap save
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef HILBERT_HH
+#define HILBERT_HH
+
+#include "memory.hh"
+
+namespace FFT {
+
+/*
+Turns a real signal x into the analytic signal x + j H(x), delayed by
+DELAY = (TAPS - 1) / 2 samples, for envelope and instantaneous phase.
+H is a Blackman windowed Hilbert transformer of TAPS taps, convolved by
+overlap save with the complex kernel delta(n - DELAY) + j h(n), whose
+spectrum is computed once. Every call takes STEP = BINS - TAPS + 1 samples,
+the input is loaded straight from the caller and the history, the kernel
+spectrum multiplied while the Forward stores and the wrapped part of the
+Backward dropped while it stores.
+*/
+template <int BINS, int TAPS, typename TYPE>
+class Hilbert
+{
+public:
+	typedef typename TYPE::value_type value_type;
+	static const int DELAY = (TAPS - 1) / 2;
+	static const int STEP = BINS - TAPS + 1;
+private:
+	static_assert(TAPS % 2 == 1, "TAPS has to be odd");
+	static_assert(STEP > 0, "BINS has to be larger than TAPS");
+	static const int HISTORY = TAPS - 1;
+	Forward<BINS, TYPE> fwd;
+	Backward<BINS, TYPE> bwd;
+	TYPE kernel[BINS];
+	value_type history[HISTORY ? HISTORY : 1];
+public:
+	Hilbert()
+	{
+		Scratch scratch;
+		TYPE *tmp = scratch.get<TYPE>(BINS);
+		for (int n = 0; n < BINS; ++n)
+			tmp[n] = 0;
+		for (int n = 0; n < TAPS; ++n) {
+			int m = n - DELAY;
+			value_type x = value_type(2 * M_PI) * value_type(n) / value_type(TAPS - 1 ? TAPS - 1 : 1);
+			value_type w = value_type(0.42) - value_type(0.5) * std::cos(x) + value_type(0.08) * std::cos(value_type(2) * x);
+			tmp[n] = TYPE(m ? value_type(0) : value_type(1), m & 1 ? w * value_type(2) / (value_type(M_PI) * value_type(m)) : value_type(0));
+		}
+		fwd(kernel, tmp);
+		for (int k = 0; k < BINS; ++k)
+			kernel[k] /= value_type(BINS);
+		for (int n = 0; n < HISTORY; ++n)
+			history[n] = 0;
+	}
+	void operator ()(TYPE *out, const value_type *in)
+	{
+		Scratch scratch;
+		TYPE *tmp = scratch.get<TYPE>(BINS), *spec = scratch.get<TYPE>(BINS);
+		auto block = [&](int n) { return TYPE(n < HISTORY ? history[n] : in[n - HISTORY]); };
+		auto convolve = [&](int k, TYPE v) { spec[k] = kernel[k] * v; };
+		auto keep = [&](int n, TYPE v) {
+			if (n >= HISTORY)
+				out[n - HISTORY] = v;
+		};
+		fwd(store(tmp, convolve), load(block));
+		bwd(store(tmp, keep), spec);
+		for (int n = 0; n < HISTORY; ++n)
+			history[n] = n < HISTORY - STEP ? history[n + STEP] : in[n - (HISTORY - STEP)];
+	}
+	// count * STEP samples
+	void operator ()(TYPE *out, const value_type *in, int count)
+	{
+		for (int i = 0; i < count; ++i)
+			(*this)(out + STEP * i, in + STEP * i);
+	}
+};
+
+}
+
+#endif
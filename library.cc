@@ -0,0 +1,104 @@
+/*
+library - entry points of library.hh, dispatched to the best instruction set
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "library.hh"
+#include "arch.hh"
+
+namespace FFT {
+
+/*
+The variants of arch.cc from the best to the worst, the first one the cpu
+supports is taken on the first call. FFT_ARCH in the environment selects
+one by name for testing, as long as the cpu supports it.
+*/
+static bool usable(const Kernels *kernels)
+{
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+	if (kernels == &avx512_kernels)
+		return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+			__builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512bw");
+	if (kernels == &avx2_kernels)
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+	(void)kernels;
+	return true;
+}
+
+static const Kernels *select()
+{
+#if defined(__x86_64__)
+	const Kernels *list[] = { &avx512_kernels, &avx2_kernels, &sse2_kernels };
+#else
+	const Kernels *list[] = { &generic_kernels };
+#endif
+	const char *name = std::getenv("FFT_ARCH");
+	if (name) {
+		for (const Kernels *kernels : list)
+			if (!std::strcmp(name, kernels->name) && usable(kernels))
+				return kernels;
+	}
+	for (const Kernels *kernels : list)
+		if (usable(kernels))
+			return kernels;
+	return list[0];
+}
+
+static inline const Kernels &kernels()
+{
+	static const Kernels *chosen = select();
+	return *chosen;
+}
+
+const char *arch()
+{
+	return kernels().name;
+}
+
+bool forward(Complex<float> *out, const Complex<float> *in, int bins)
+{
+	return kernels().forward_float(reinterpret_cast<float *>(out), reinterpret_cast<const float *>(in), bins);
+}
+
+bool backward(Complex<float> *out, const Complex<float> *in, int bins)
+{
+	return kernels().backward_float(reinterpret_cast<float *>(out), reinterpret_cast<const float *>(in), bins);
+}
+
+bool forward(Complex<double> *out, const Complex<double> *in, int bins)
+{
+	return kernels().forward_double(reinterpret_cast<double *>(out), reinterpret_cast<const double *>(in), bins);
+}
+
+bool backward(Complex<double> *out, const Complex<double> *in, int bins)
+{
+	return kernels().backward_double(reinterpret_cast<double *>(out), reinterpret_cast<const double *>(in), bins);
+}
+
+#define FFT_SIZE(BINS) \
+	void forward##BINS(Complex<float> *out, const Complex<float> *in) \
+	{ \
+		forward(out, in, BINS); \
+	} \
+	void backward##BINS(Complex<float> *out, const Complex<float> *in) \
+	{ \
+		backward(out, in, BINS); \
+	} \
+	void forward##BINS(Complex<double> *out, const Complex<double> *in) \
+	{ \
+		forward(out, in, BINS); \
+	} \
+	void backward##BINS(Complex<double> *out, const Complex<double> *in) \
+	{ \
+		backward(out, in, BINS); \
+	}
+#include FFT_LIBRARY_SIZES
+#undef FFT_SIZE
+
+}
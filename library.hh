@@ -0,0 +1,47 @@
+/*
+library - entry points of the prebuilt transforms
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef LIBRARY_HH
+#define LIBRARY_HH
+
+#include "complex.hh"
+
+/*
+Translation units including only this header compile none of the recursion,
+they call into libfft.a or libfft.so. arch.cc builds every size of
+FFT_LIBRARY_SIZES, library.def unless given otherwise, once for every
+instruction set and library.cc picks the best one the cpu supports.
+forward1920 and so on exist for every size, float and double, forward and
+backward take the size at run time and return false for other sizes.
+Forward and Backward of fft.hh are not redirected here, they are always
+compiled where they are used, so calls meant for the library go through
+these functions.
+*/
+#ifndef FFT_LIBRARY_SIZES
+#define FFT_LIBRARY_SIZES "library.def"
+#endif
+
+namespace FFT {
+
+#define FFT_SIZE(BINS) \
+	void forward##BINS(Complex<float> *out, const Complex<float> *in); \
+	void backward##BINS(Complex<float> *out, const Complex<float> *in); \
+	void forward##BINS(Complex<double> *out, const Complex<double> *in); \
+	void backward##BINS(Complex<double> *out, const Complex<double> *in);
+#include FFT_LIBRARY_SIZES
+#undef FFT_SIZE
+
+bool forward(Complex<float> *out, const Complex<float> *in, int bins);
+bool backward(Complex<float> *out, const Complex<float> *in, int bins);
+bool forward(Complex<double> *out, const Complex<double> *in, int bins);
+bool backward(Complex<double> *out, const Complex<double> *in, int bins);
+
+// name of the instruction set the library runs on, like avx2
+const char *arch();
+
+}
+
+#endif
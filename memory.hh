@@ -0,0 +1,293 @@
+/*
+memory - aligned buffers on huge pages and per thread scratch for the transforms
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef MEMORY_HH
+#define MEMORY_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace FFT {
+
+/*
+BASE_PAGES keeps a block on pages of the base size, TRANSPARENT_HUGE_PAGES
+asks the kernel to back it with transparent huge pages and
+EXPLICIT_HUGE_PAGES takes them from the pool reserved in
+/proc/sys/vm/nr_hugepages, falling back to transparent ones if the pool is
+empty. Only blocks of at least HUGE_PAGE bytes are mapped like this, the
+smaller ones come from the heap.
+*/
+enum Pages { BASE_PAGES, TRANSPARENT_HUGE_PAGES, EXPLICIT_HUGE_PAGES };
+
+static const size_t ALIGNMENT = 64;
+static const size_t HUGE_PAGE = 2 << 20;
+
+static inline size_t mapped_size(size_t bytes)
+{
+	return (bytes + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1);
+}
+
+#ifdef __linux__
+static inline void *map_block(size_t size, Pages pages)
+{
+	const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+	if (pages == EXPLICIT_HUGE_PAGES) {
+		// MAP_HUGE_2MB, as the default size of the pool might be 1GiB
+		void *block = mmap(0, size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB | (21 << 26), -1, 0);
+		if (block != MAP_FAILED)
+			return block;
+		pages = TRANSPARENT_HUGE_PAGES;
+	}
+	// one huge page more, so the block can start on a huge page boundary
+	char *area = static_cast<char *>(mmap(0, size + HUGE_PAGE, PROT_READ | PROT_WRITE, flags, -1, 0));
+	if (area == MAP_FAILED)
+		return 0;
+	char *block = area + (-reinterpret_cast<uintptr_t>(area) & (HUGE_PAGE - 1));
+	if (block != area)
+		munmap(area, block - area);
+	munmap(block + size, area + HUGE_PAGE - block);
+	madvise(block, size, pages == BASE_PAGES ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+	return block;
+}
+#endif
+
+/*
+A block of at least bytes, aligned to ALIGNMENT, 0 if there is no memory.
+Mapped blocks are bound to the local numa node, so their pages end up on
+the node of the thread that writes them first, even under an interleaving
+policy of the whole process. So buffers are best filled by the thread
+that is going to transform them.
+*/
+static inline void *allocate_block(size_t bytes, Pages pages = TRANSPARENT_HUGE_PAGES)
+{
+#ifdef __linux__
+	if (bytes >= HUGE_PAGE) {
+		void *block = map_block(mapped_size(bytes), pages);
+		// MPOL_LOCAL
+		if (block)
+			syscall(SYS_mbind, block, mapped_size(bytes), 4, 0, 0, 0);
+		return block;
+	}
+#else
+	(void)pages;
+#endif
+	void *block;
+	if (posix_memalign(&block, ALIGNMENT, std::max(bytes, size_t(1))))
+		return 0;
+	return block;
+}
+
+// bytes have to be the same as given to allocate_block
+static inline void release_block(void *block, size_t bytes)
+{
+	if (!block)
+		return;
+#ifdef __linux__
+	if (bytes >= HUGE_PAGE) {
+		munmap(block, mapped_size(bytes));
+		return;
+	}
+#endif
+	std::free(block);
+}
+
+// bytes of the mapping holding block that are backed by huge pages, from /proc/self/smaps
+static inline size_t huge_bytes(const void *block)
+{
+	std::ifstream smaps("/proc/self/smaps");
+	std::string line;
+	uintptr_t address = reinterpret_cast<uintptr_t>(block);
+	bool inside = false;
+	size_t total = 0;
+	while (std::getline(smaps, line)) {
+		size_t dash = line.find('-');
+		if (dash != std::string::npos && dash < line.find(' ') && line.find(':') > line.find(' ')) {
+			if (inside)
+				break;
+			uintptr_t begin = std::stoull(line.substr(0, dash), 0, 16);
+			uintptr_t end = std::stoull(line.substr(dash + 1), 0, 16);
+			inside = begin <= address && address < end;
+			continue;
+		}
+		if (!inside)
+			continue;
+		std::istringstream fields(line);
+		std::string name;
+		size_t kb;
+		if (fields >> name >> kb && (name == "AnonHugePages:" || name == "Private_Hugetlb:" || name == "Shared_Hugetlb:"))
+			total += kb << 10;
+	}
+	return total;
+}
+
+template <typename T, Pages PAGES = TRANSPARENT_HUGE_PAGES>
+struct Allocator
+{
+	typedef T value_type;
+	template <typename U>
+	struct rebind
+	{
+		typedef Allocator<U, PAGES> other;
+	};
+	Allocator() {}
+	template <typename U>
+	Allocator(const Allocator<U, PAGES> &) {}
+	T *allocate(size_t count)
+	{
+		void *block = allocate_block(count * sizeof(T), PAGES);
+		if (!block)
+			throw std::bad_alloc();
+		return static_cast<T *>(block);
+	}
+	void deallocate(T *block, size_t count)
+	{
+		release_block(block, count * sizeof(T));
+	}
+};
+
+template <typename T, typename U, Pages PAGES>
+inline bool operator == (const Allocator<T, PAGES> &, const Allocator<U, PAGES> &)
+{
+	return true;
+}
+
+template <typename T, typename U, Pages PAGES>
+inline bool operator != (const Allocator<T, PAGES> &, const Allocator<U, PAGES> &)
+{
+	return false;
+}
+
+// aligned array for samples and spectra, on huge pages when large enough
+template <typename T, Pages PAGES = TRANSPARENT_HUGE_PAGES>
+using Buffer = std::vector<T, Allocator<T, PAGES>>;
+
+/*
+Scratch memory of one thread, handed out and given back in stack order.
+A request that does not fit into the current block takes a new block, so
+what was handed out before stays where it is. Once everything is given
+back, the blocks are replaced by a single one as large as the most ever
+in use, so after the first call of every plan drawing scratch is adding to
+an offset and never calls malloc. The blocks are first written by their
+own thread and so are local to its numa node.
+*/
+class Arena
+{
+	struct Block
+	{
+		char *data;
+		size_t size;
+	};
+	static const size_t MINIMUM = 64 << 10;
+	std::vector<Block> blocks;
+	size_t block, offset, live, peak;
+	void clear()
+	{
+		for (Block &b : blocks)
+			release_block(b.data, b.size);
+		blocks.clear();
+	}
+public:
+	struct Mark
+	{
+		size_t block, offset, live;
+	};
+	Arena() : block(0), offset(0), live(0), peak(0) {}
+	~Arena()
+	{
+		clear();
+	}
+	Arena(const Arena &) = delete;
+	Arena &operator = (const Arena &) = delete;
+	static Arena &local()
+	{
+		static thread_local Arena arena;
+		return arena;
+	}
+	inline Mark mark() const
+	{
+		return Mark { block, offset, live };
+	}
+	void *take(size_t bytes)
+	{
+		bytes = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+		while (block < blocks.size() && offset + bytes > blocks[block].size) {
+			live += blocks[block].size - offset;
+			offset = 0;
+			++block;
+		}
+		if (block == blocks.size()) {
+			size_t size = std::max(bytes, size_t(MINIMUM));
+			char *data = static_cast<char *>(allocate_block(size));
+			if (!data)
+				return 0;
+			blocks.push_back(Block { data, size });
+		}
+		char *data = blocks[block].data + offset;
+		offset += bytes;
+		live += bytes;
+		peak = std::max(peak, live);
+		return data;
+	}
+	void restore(const Mark &mark)
+	{
+		block = mark.block;
+		offset = mark.offset;
+		live = mark.live;
+		if (live || blocks.size() < 2)
+			return;
+		clear();
+		char *data = static_cast<char *>(allocate_block(peak));
+		if (data)
+			blocks.push_back(Block { data, peak });
+	}
+	// bytes held by the blocks
+	size_t capacity() const
+	{
+		size_t size = 0;
+		for (const Block &b : blocks)
+			size += b.size;
+		return size;
+	}
+};
+
+// scratch from the arena of this thread, given back at the end of the scope
+class Scratch
+{
+	Arena &arena;
+	Arena::Mark mark;
+public:
+	Scratch(Arena &arena = Arena::local()) : arena(arena), mark(arena.mark()) {}
+	~Scratch()
+	{
+		arena.restore(mark);
+	}
+	Scratch(const Scratch &) = delete;
+	Scratch &operator = (const Scratch &) = delete;
+	// throws std::bad_alloc like Allocator when the arena can not grow, so the transforms never see a null pointer
+	template <typename TYPE>
+	inline TYPE *get(size_t count)
+	{
+		void *block = arena.take(count * sizeof(TYPE));
+		if (!block)
+			throw std::bad_alloc();
+		return static_cast<TYPE *>(block);
+	}
+};
+
+}
+
+#endif
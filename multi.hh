@@ -0,0 +1,243 @@
+/*
+multi - multidimensional transforms on top of the mixed radix fft
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef MULTI_HH
+#define MULTI_HH
+
+#include <algorithm>
+#include "memory.hh"
+#include "parallel.hh"
+
+namespace FFT {
+
+/*
+Transforms the columns [begin, end) of a row major matrix with BINS rows.
+Columns are gathered a cache line wide at a time, so every line that gets
+loaded from the matrix is fully used and the transposed block stays in cache
+while it is transformed and scattered back.
+*/
+template <int BINS, typename TYPE>
+struct Columns
+{
+	static const int BLOCK = sizeof(TYPE) < 64 ? 64 / sizeof(TYPE) : 1;
+	static const int SCRATCH = 2 * BLOCK * BINS;
+	static constexpr int blocks(int count)
+	{
+		return (count + BLOCK - 1) / BLOCK;
+	}
+	template <typename PLAN>
+	static void run(PLAN &fft, TYPE *out, const TYPE *in, int stride, int begin, int end, TYPE *tmp)
+	{
+		TYPE *a = tmp, *b = tmp + BLOCK * BINS;
+		for (int c = begin; c < end; c += BLOCK) {
+			int w = end - c < BLOCK ? end - c : BLOCK;
+			for (int n = 0; n < BINS; ++n)
+				for (int j = 0; j < w; ++j)
+					a[BINS * j + n] = in[stride * n + c + j];
+			for (int j = 0; j < w; ++j)
+				fft(b + BINS * j, a + BINS * j);
+			for (int n = 0; n < BINS; ++n)
+				for (int j = 0; j < w; ++j)
+					out[stride * n + c + j] = b[BINS * j + n];
+		}
+	}
+};
+
+template <int PLANES, int ROWS, int COLS, typename TYPE, int SIGN>
+class Complex3D
+{
+	typedef Columns<ROWS, TYPE> Col;
+	typedef Columns<PLANES, TYPE> Pln;
+	static const int SCRATCH = Col::SCRATCH > Pln::SCRATCH ? Col::SCRATCH : Pln::SCRATCH;
+	typename Direction<COLS, TYPE, SIGN>::type row;
+	typename Direction<ROWS, TYPE, SIGN>::type col;
+	typename Direction<PLANES, TYPE, SIGN>::type pln;
+	Workers workers;
+public:
+	typedef typename TYPE::value_type value_type;
+	Complex3D(int threads = 1) : workers(threads) {}
+	void operator ()(TYPE *out, const TYPE *in)
+	{
+		workers(PLANES * ROWS, [&](int r, int) {
+			row(out + COLS * r, in + COLS * r);
+		});
+		if (ROWS > 1) {
+			workers(PLANES * Col::blocks(COLS), [&](int i, int) {
+				Scratch scratch;
+				int p = i / Col::blocks(COLS), c = Col::BLOCK * (i % Col::blocks(COLS));
+				TYPE *plane = out + ROWS * COLS * p;
+				Col::run(col, plane, plane, COLS, c, std::min(COLS, c + Col::BLOCK), scratch.get<TYPE>(SCRATCH));
+			});
+		}
+		if (PLANES > 1) {
+			workers(Pln::blocks(ROWS * COLS), [&](int i, int) {
+				Scratch scratch;
+				int c = Pln::BLOCK * i;
+				Pln::run(pln, out, out, ROWS * COLS, c, std::min(ROWS * COLS, c + Pln::BLOCK), scratch.get<TYPE>(SCRATCH));
+			});
+		}
+	}
+};
+
+/*
+Real input is transformed two rows at a time by packing them into the real
+and imaginary parts of one complex row. Only the COLS / 2 + 1 non redundant
+columns of the spectrum are stored and carried through the column passes.
+*/
+template <int PLANES, int ROWS, int COLS, typename TYPE>
+class RealForward3D
+{
+	static const int HALF = COLS / 2 + 1;
+	typedef Columns<ROWS, TYPE> Col;
+	typedef Columns<PLANES, TYPE> Pln;
+	static const int BLOCKS = Col::SCRATCH > Pln::SCRATCH ? Col::SCRATCH : Pln::SCRATCH;
+	static const int SCRATCH = 2 * COLS > BLOCKS ? 2 * COLS : BLOCKS;
+	Forward<COLS, TYPE> row;
+	Forward<ROWS, TYPE> col;
+	Forward<PLANES, TYPE> pln;
+	Workers workers;
+public:
+	typedef typename TYPE::value_type value_type;
+	RealForward3D(int threads = 1) : workers(threads) {}
+	void operator ()(TYPE *out, const value_type *in)
+	{
+		workers((PLANES * ROWS + 1) / 2, [&](int i, int) {
+			Scratch scratch;
+			int r = 2 * i;
+			const value_type *x = in + COLS * r, *y = r + 1 < PLANES * ROWS ? x + COLS : 0;
+			TYPE *a = scratch.get<TYPE>(SCRATCH), *b = a + COLS;
+			for (int n = 0; n < COLS; ++n)
+				a[n] = TYPE(x[n], y ? y[n] : value_type(0));
+			row(b, a);
+			TYPE *X = out + HALF * r, *Y = X + HALF;
+			for (int k = 0; k < HALF; ++k) {
+				TYPE p(b[k]), q(conj(b[(COLS - k) % COLS])), d(p - q);
+				X[k] = value_type(0.5) * (p + q);
+				if (y)
+					Y[k] = value_type(0.5) * TYPE(d.imag(), -d.real());
+			}
+		});
+		if (ROWS > 1) {
+			workers(PLANES * Col::blocks(HALF), [&](int i, int) {
+				Scratch scratch;
+				int p = i / Col::blocks(HALF), c = Col::BLOCK * (i % Col::blocks(HALF));
+				TYPE *plane = out + ROWS * HALF * p;
+				Col::run(col, plane, plane, HALF, c, std::min(HALF, c + Col::BLOCK), scratch.get<TYPE>(SCRATCH));
+			});
+		}
+		if (PLANES > 1) {
+			workers(Pln::blocks(ROWS * HALF), [&](int i, int) {
+				Scratch scratch;
+				int c = Pln::BLOCK * i;
+				Pln::run(pln, out, out, ROWS * HALF, c, std::min(ROWS * HALF, c + Pln::BLOCK), scratch.get<TYPE>(SCRATCH));
+			});
+		}
+	}
+};
+
+template <int PLANES, int ROWS, int COLS, typename TYPE>
+class RealBackward3D
+{
+	static const int HALF = COLS / 2 + 1;
+	typedef Columns<ROWS, TYPE> Col;
+	typedef Columns<PLANES, TYPE> Pln;
+	static const int BLOCKS = Col::SCRATCH > Pln::SCRATCH ? Col::SCRATCH : Pln::SCRATCH;
+	static const int SCRATCH = 2 * COLS > BLOCKS ? 2 * COLS : BLOCKS;
+	Backward<COLS, TYPE> row;
+	Backward<ROWS, TYPE> col;
+	Backward<PLANES, TYPE> pln;
+	Workers workers;
+	Buffer<TYPE> work;
+public:
+	typedef typename TYPE::value_type value_type;
+	RealBackward3D(int threads = 1) : workers(threads), work(PLANES * ROWS * HALF) {}
+	void operator ()(value_type *out, const TYPE *in)
+	{
+		const TYPE *src = in;
+		TYPE *dst = work.data();
+		if (PLANES > 1) {
+			workers(Pln::blocks(ROWS * HALF), [&](int i, int) {
+				Scratch scratch;
+				int c = Pln::BLOCK * i;
+				Pln::run(pln, dst, src, ROWS * HALF, c, std::min(ROWS * HALF, c + Pln::BLOCK), scratch.get<TYPE>(SCRATCH));
+			});
+			src = dst;
+		}
+		if (ROWS > 1) {
+			workers(PLANES * Col::blocks(HALF), [&](int i, int) {
+				Scratch scratch;
+				int p = i / Col::blocks(HALF), c = Col::BLOCK * (i % Col::blocks(HALF));
+				Col::run(col, dst + ROWS * HALF * p, src + ROWS * HALF * p, HALF, c, std::min(HALF, c + Col::BLOCK), scratch.get<TYPE>(SCRATCH));
+			});
+			src = dst;
+		}
+		workers((PLANES * ROWS + 1) / 2, [&](int i, int) {
+			Scratch scratch;
+			int r = 2 * i;
+			const TYPE *X = src + HALF * r, *Y = r + 1 < PLANES * ROWS ? X + HALF : 0;
+			TYPE *a = scratch.get<TYPE>(SCRATCH), *b = a + COLS;
+			for (int k = 0; k < COLS; ++k) {
+				TYPE p(k < HALF ? X[k] : conj(X[COLS - k])), q;
+				if (Y)
+					q = k < HALF ? Y[k] : conj(Y[COLS - k]);
+				a[k] = p + TYPE(-q.imag(), q.real());
+			}
+			row(b, a);
+			value_type *x = out + COLS * r, *y = x + COLS;
+			for (int n = 0; n < COLS; ++n)
+				x[n] = b[n].real();
+			if (Y)
+				for (int n = 0; n < COLS; ++n)
+					y[n] = b[n].imag();
+		});
+	}
+};
+
+template <int PLANES, int ROWS, int COLS, typename TYPE>
+class Forward3D : public Complex3D<PLANES, ROWS, COLS, TYPE, -1>
+{
+public:
+	Forward3D(int threads = 1) : Complex3D<PLANES, ROWS, COLS, TYPE, -1>(threads) {}
+};
+
+template <int PLANES, int ROWS, int COLS, typename TYPE>
+class Backward3D : public Complex3D<PLANES, ROWS, COLS, TYPE, 1>
+{
+public:
+	Backward3D(int threads = 1) : Complex3D<PLANES, ROWS, COLS, TYPE, 1>(threads) {}
+};
+
+template <int ROWS, int COLS, typename TYPE>
+class Forward2D : public Complex3D<1, ROWS, COLS, TYPE, -1>
+{
+public:
+	Forward2D(int threads = 1) : Complex3D<1, ROWS, COLS, TYPE, -1>(threads) {}
+};
+
+template <int ROWS, int COLS, typename TYPE>
+class Backward2D : public Complex3D<1, ROWS, COLS, TYPE, 1>
+{
+public:
+	Backward2D(int threads = 1) : Complex3D<1, ROWS, COLS, TYPE, 1>(threads) {}
+};
+
+template <int ROWS, int COLS, typename TYPE>
+class RealForward2D : public RealForward3D<1, ROWS, COLS, TYPE>
+{
+public:
+	RealForward2D(int threads = 1) : RealForward3D<1, ROWS, COLS, TYPE>(threads) {}
+};
+
+template <int ROWS, int COLS, typename TYPE>
+class RealBackward2D : public RealBackward3D<1, ROWS, COLS, TYPE>
+{
+public:
+	RealBackward2D(int threads = 1) : RealBackward3D<1, ROWS, COLS, TYPE>(threads) {}
+};
+
+}
+
+#endif
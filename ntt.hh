@@ -0,0 +1,269 @@
+/*
+ntt - number theoretic transform for exact integer convolution
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef NTT_HH
+#define NTT_HH
+
+#include <cstdint>
+#include "memory.hh"
+
+namespace FFT {
+
+static constexpr uint32_t mod_pow(uint64_t b, uint64_t e, uint32_t P)
+{
+	return e ? (e & 1 ? b * mod_pow(b * b % P, e / 2, P) % P : mod_pow(b * b % P, e / 2, P)) : 1;
+}
+
+// primitive roots of the supported primes, 0 for unknown primes
+static constexpr uint32_t primitive_root(uint32_t P)
+{
+	return
+		P == 998244353 ? 3 : // 7 * 17 * 2^23 + 1
+		P == 167772161 ? 3 : // 5 * 2^25 + 1
+		P == 469762049 ? 3 : // 7 * 2^26 + 1
+		P == 754974721 ? 11 : // 3^2 * 5 * 2^24 + 1
+		0;
+}
+
+// -P^-1 modulo 2^32 by Newton's iteration
+static constexpr uint32_t mont_inverse(uint32_t P, uint32_t x, int n = 4)
+{
+	return n ? mont_inverse(P, x * (2 - P * x), n - 1) : -x;
+}
+
+// root of unity standing in for exp(j 2 pi n / N)
+static constexpr uint32_t unit_root(int n, int N, uint32_t P)
+{
+	return mod_pow(primitive_root(P), (P - 1) / N * uint64_t(n % N + N) % (P - 1), P);
+}
+
+/*
+Element of the prime field of P in Montgomery form, so a multiplication is
+a 32x32 bit product and a reduction without division. Values stay below P.
+With exp(j 2 pi / N) mapped to a primitive N-th root of unity and j to the
+root of order four, the radix kernels of fft.hh do exact transforms over the
+field for every N dividing P - 1.
+*/
+template <uint32_t P>
+class Mod
+{
+	static_assert(P % 2 == 1 && P < (uint32_t(1) << 31), "P has to be an odd prime below 2^31");
+	static constexpr uint32_t reduce(uint64_t t)
+	{
+		return fix(uint32_t((t + uint64_t(uint32_t(t) * NEG_INV) * P) >> 32));
+	}
+	static constexpr uint32_t fix(uint32_t a)
+	{
+		return a >= P ? a - P : a;
+	}
+	static const uint32_t NEG_INV = mont_inverse(P, P);
+	static const uint32_t R2 = uint64_t((uint64_t(1) << 32) % P) * ((uint64_t(1) << 32) % P) % P;
+	struct Raw {};
+	uint32_t v;
+	constexpr Mod(uint32_t m, Raw) : v(m) {}
+public:
+	typedef uint32_t value_type;
+	static const uint32_t modulus = P;
+	constexpr Mod() : v(0) {}
+	constexpr Mod(uint32_t a) : v(reduce(uint64_t(a % P) * R2)) {}
+	constexpr uint32_t value() const
+	{
+		return reduce(v);
+	}
+	constexpr Mod operator + (Mod a) const
+	{
+		return Mod(fix(v + a.v), Raw());
+	}
+	constexpr Mod operator - (Mod a) const
+	{
+		return Mod(v >= a.v ? v - a.v : v + P - a.v, Raw());
+	}
+	constexpr Mod operator - () const
+	{
+		return Mod(v ? P - v : 0, Raw());
+	}
+	constexpr Mod operator * (Mod a) const
+	{
+		return Mod(reduce(uint64_t(v) * a.v), Raw());
+	}
+	inline Mod operator += (Mod a)
+	{
+		return *this = *this + a;
+	}
+	inline Mod operator -= (Mod a)
+	{
+		return *this = *this - a;
+	}
+	inline Mod operator *= (Mod a)
+	{
+		return *this = *this * a;
+	}
+	Mod pow(uint64_t e) const
+	{
+		Mod r(1), b(*this);
+		for (; e; e /= 2, b *= b)
+			if (e & 1)
+				r *= b;
+		return r;
+	}
+	Mod inverse() const
+	{
+		return pow(P - 2);
+	}
+};
+
+template <int n, int N, uint32_t P>
+static inline Mod<P> cx(Mod<P> a)
+{
+	static_assert((P - 1) % N == 0, "N has to divide P - 1");
+	constexpr Mod<P> c(uint64_t(unit_root(n, N, P) + unit_root(-n, N, P)) * ((P + 1) / 2) % P);
+	return c * a;
+}
+
+// sin = (w^n - w^-n) / 2j and 1 / j = -j
+template <int n, int N, uint32_t P>
+static inline Mod<P> sx(Mod<P> a)
+{
+	static_assert((P - 1) % N == 0 && (P - 1) % 4 == 0, "N and 4 have to divide P - 1");
+	constexpr Mod<P> s(uint64_t(unit_root(n, N, P) + P - unit_root(-n, N, P)) * ((P + 1) / 2) % P * (P - unit_root(1, 4, P)) % P);
+	return s * a;
+}
+
+template <uint32_t P>
+static inline Mod<P> rsqrt2(Mod<P> a)
+{
+	return cx<1, 8>(a);
+}
+
+// -j (a - b)
+template <uint32_t P>
+static inline Mod<P> twiddle(Mod<P> a, Mod<P> b)
+{
+	constexpr Mod<P> j(unit_root(1, 4, P));
+	return j * (b - a);
+}
+
+// (a - b) - j (a + b)
+template <uint32_t P>
+static inline Mod<P> fiddle(Mod<P> a, Mod<P> b)
+{
+	constexpr Mod<P> j(unit_root(1, 4, P));
+	return (a - b) - j * (a + b);
+}
+
+template <int BINS, uint32_t P, int SIGN>
+class Factors<BINS, Mod<P>, SIGN>
+{
+	static_assert(primitive_root(P), "unsupported prime");
+	static_assert((P - 1) % BINS == 0, "BINS has to divide P - 1");
+	Mod<P> z[BINS];
+public:
+	Factors()
+	{
+		Mod<P> w(unit_root(SIGN, BINS, P));
+		z[0] = 1;
+		for (int n = 1; n < BINS; ++n)
+			z[n] = z[n - 1] * w;
+	}
+	inline operator const Mod<P> * () const
+	{
+		return z;
+	}
+};
+
+/*
+Exact linear convolution of unsigned integers, modulo 2^64. Every product
+is done modulo three primes, each with two Forward and one Backward, and
+put together with Garner's algorithm. The result is exact as long as the
+true values stay below 2^64, the product of the primes is about 2^85.
+The pointwise product is taken while the second Forward stores and the
+result is scaled while the Backward stores. BINS has to be a power of two
+up to 2^24, the only sizes all three primes support.
+*/
+template <int BINS>
+class Convolution
+{
+	static const uint32_t P1 = 167772161, P2 = 469762049, P3 = 754974721;
+	static_assert((BINS & (BINS - 1)) == 0 && BINS <= (1 << 24), "BINS has to be a power of two up to 2^24");
+	template <uint32_t P>
+	struct Residue
+	{
+		Forward<BINS, Mod<P>> fwd;
+		Backward<BINS, Mod<P>> bwd;
+		uint32_t res[BINS];
+		template <typename A, typename B>
+		void operator ()(A a, int na, B b, int nb)
+		{
+			Scratch scratch;
+			Mod<P> *tmp = scratch.get<Mod<P>>(BINS), *spec = scratch.get<Mod<P>>(BINS);
+			Mod<P> scale = Mod<P>(BINS).inverse();
+			auto first = [&](int n) { return n < na ? Mod<P>(a(n)) : Mod<P>(0); };
+			auto second = [&](int n) { return n < nb ? Mod<P>(b(n)) : Mod<P>(0); };
+			auto product = [&](int k, Mod<P> v) { spec[k] *= v; };
+			auto result = [&](int n, Mod<P> v) { res[n] = (scale * v).value(); };
+			fwd(spec, load(first));
+			fwd(store(tmp, product), load(second));
+			bwd(store(tmp, result), spec);
+		}
+	};
+	Residue<P1> r1;
+	Residue<P2> r2;
+	Residue<P3> r3;
+public:
+	// out(n, value) for n < na + nb - 1, a(n) for n < na and b(n) for n < nb
+	template <typename OUT, typename A, typename B>
+	void apply(OUT out, A a, int na, B b, int nb)
+	{
+		r1(a, na, b, nb);
+		r2(a, na, b, nb);
+		r3(a, na, b, nb);
+		const Mod<P2> i12(Mod<P2>(P1).inverse());
+		const Mod<P3> i13(Mod<P3>(P1).inverse()), i23(Mod<P3>(P2).inverse());
+		for (int n = 0; n < na + nb - 1; ++n) {
+			uint32_t x1 = r1.res[n];
+			uint32_t x2 = ((Mod<P2>(r2.res[n]) - Mod<P2>(x1)) * i12).value();
+			uint32_t x3 = (((Mod<P3>(r3.res[n]) - Mod<P3>(x1)) * i13 - Mod<P3>(x2)) * i23).value();
+			out(n, x1 + uint64_t(P1) * (x2 + uint64_t(P2) * x3));
+		}
+	}
+	void operator ()(uint64_t *out, const uint32_t *a, int na, const uint32_t *b, int nb)
+	{
+		apply([=](int n, uint64_t v) { out[n] = v; }, [=](int n) { return a[n]; }, na, [=](int n) { return b[n]; }, nb);
+	}
+};
+
+/*
+Big integer multiplication, little endian 32 bit words. The words are split
+into 16 bit digits, whose convolution stays below 2^56 for all supported
+sizes, then the carries are propagated. na + nb words of out are written,
+2 * (na + nb) - 1 digits have to fit into BINS.
+*/
+template <int BINS>
+class Multiply
+{
+	Convolution<BINS> conv;
+public:
+	void operator ()(uint32_t *out, const uint32_t *a, int na, const uint32_t *b, int nb)
+	{
+		for (int n = 0; n < na + nb; ++n)
+			out[n] = 0;
+		uint64_t carry = 0;
+		auto digits = [&](int n, uint64_t v) {
+			carry += v;
+			out[n / 2] |= uint32_t(carry & 0xffff) << (16 * (n & 1));
+			carry >>= 16;
+		};
+		conv.apply(digits,
+			[=](int n) { return (a[n / 2] >> (16 * (n & 1))) & 0xffff; }, 2 * na,
+			[=](int n) { return (b[n / 2] >> (16 * (n & 1))) & 0xffff; }, 2 * nb);
+		for (int n = 2 * (na + nb) - 1; carry; ++n, carry >>= 16)
+			out[n / 2] |= uint32_t(carry & 0xffff) << (16 * (n & 1));
+	}
+};
+
+}
+
+#endif
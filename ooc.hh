@@ -0,0 +1,224 @@
+/*
+ooc - out of core transforms of files larger than memory
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef OOC_HH
+#define OOC_HH
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "memory.hh"
+#include "parallel.hh"
+
+namespace FFT {
+
+/*
+Transforms BINS = N1 * N2 samples of TYPE in one file into another file,
+which may be far more than fits into memory, with the six step algorithm.
+The input x[n1 + N1 n2] is taken as a matrix of N2 rows and N1 columns.
+The transposes are folded into the places the passes read from and write
+to, so the data goes through memory only twice:
+The first pass reads groups of columns, transforms each down its N2 rows,
+multiplies with the twiddle factors W^(n1 k2) of BINS while the last stage
+stores and writes the group as consecutive rows of the output, so the
+output holds the transpose. The second pass reads groups of columns of that,
+transforms each down its N1 rows and writes them back to where they came
+from, which is X[k2 + N2 k1], the natural order.
+Columns are read and written as one segment per row, so the segments are
+as long as a group is wide, about memory / (4 N2) samples in the first
+pass and memory / (4 N1) in the second, which makes N1 close to N2 the
+best choice. While one group is transformed, a thread writes the one
+before and reads the next, announcing all its segments to the kernel
+first, so the drive sees many requests at once.
+*/
+template <int N1, int N2, typename TYPE, int SIGN>
+class OutOfCore
+{
+public:
+	typedef typename TYPE::value_type value_type;
+	static const long long BINS = (long long)N1 * N2;
+private:
+	static_assert(N1 > 1 && N2 > 1, "N1 and N2 have to be larger than one");
+	typename Direction<N1, TYPE, SIGN>::type rows;
+	typename Direction<N2, TYPE, SIGN>::type cols;
+	Workers workers;
+	int wide1, wide2;
+	Buffer<TYPE> coarse, fine, slab[4];
+	// count samples at sample offset of fd into or from buf, all or nothing
+	bool transfer(bool out, int fd, TYPE *buf, long long count, long long offset)
+	{
+		char *data = reinterpret_cast<char *>(buf);
+		size_t left = count * sizeof(TYPE);
+		off_t where = offset * sizeof(TYPE);
+		while (left) {
+			ssize_t done = out ? pwrite(fd, data, left, where) : pread(fd, data, left, where);
+			if (done < 0 && errno == EINTR)
+				continue;
+			if (done <= 0) {
+				error = done ? std::strerror(errno) : "file too short";
+				return false;
+			}
+			data += done;
+			left -= done;
+			where += done;
+		}
+		return true;
+	}
+	// rows of wide samples from stride apart, starting at offset, to or from consecutive rows of buf
+	bool segments(bool out, int fd, TYPE *buf, int count, int wide, long long stride, long long offset)
+	{
+#ifdef POSIX_FADV_WILLNEED
+		if (!out)
+			for (int r = 0; r < count; ++r)
+				posix_fadvise(fd, (offset + stride * r) * sizeof(TYPE), wide * sizeof(TYPE), POSIX_FADV_WILLNEED);
+#endif
+		for (int r = 0; r < count; ++r)
+			if (!transfer(out, fd, buf + (long long)wide * r, wide, offset + stride * r))
+				return false;
+		return true;
+	}
+	// read block i, transform it and write it while the block before is written and the next read
+	template <typename READ, typename COMPUTE, typename WRITE>
+	static bool pipeline(int blocks, READ read, COMPUTE compute, WRITE write)
+	{
+		if (!read(0))
+			return false;
+		for (int i = 0; i < blocks; ++i) {
+			bool done = true;
+			std::thread io([&]() { done = (!i || write(i - 1)) && (i + 1 == blocks || read(i + 1)); });
+			compute(i);
+			io.join();
+			if (!done)
+				return false;
+		}
+		return write(blocks - 1);
+	}
+	static int width(int i, int wide, int total)
+	{
+		return std::min(wide, total - wide * i);
+	}
+public:
+	// the reason the last transform failed
+	std::string error;
+	// wall clock time of both passes of the last transform
+	double seconds[2];
+	/*
+	memory is the size of the four buffers the groups are read into,
+	threads transform the columns of a group in parallel.
+	*/
+	OutOfCore(size_t memory = size_t(1) << 30, int threads = 1) : workers(threads), coarse(N1), fine(N2)
+	{
+		const long double TAU = 6.283185307179586476925286766559L;
+		long long samples = memory / (4 * sizeof(TYPE));
+		wide1 = int(std::max(1LL, std::min<long long>(N1, samples / N2)));
+		wide2 = int(std::max(1LL, std::min<long long>(N2, samples / N1)));
+		for (int b = 0; b < 4; ++b)
+			slab[b].resize(std::max((long long)wide1 * N2, (long long)wide2 * N1));
+		for (int h = 0; h < N1; ++h)
+			coarse[h] = TYPE(value_type(std::cos(TAU * h / N1)), value_type(SIGN * std::sin(TAU * h / N1)));
+		for (int l = 0; l < N2; ++l)
+			fine[l] = TYPE(value_type(std::cos(TAU * l / BINS)), value_type(SIGN * std::sin(TAU * l / BINS)));
+		seconds[0] = seconds[1] = 0;
+	}
+	// file descriptors open for reading and writing, out has to hold BINS samples already
+	bool operator ()(int out, int in)
+	{
+		const int blocks1 = (N1 + wide1 - 1) / wide1, blocks2 = (N2 + wide2 - 1) / wide2;
+		auto start = std::chrono::steady_clock::now();
+		bool done = pipeline(blocks1,
+			[&](int i) { return segments(false, in, slab[i % 2].data(), N2, width(i, wide1, N1), N1, (long long)wide1 * i); },
+			[&](int i) {
+				const int wide = width(i, wide1, N1);
+				const TYPE *src = slab[i % 2].data();
+				TYPE *dst = slab[2 + i % 2].data();
+				workers(wide, [&](int c, int) {
+					Scratch scratch;
+					const long long n1 = (long long)wide1 * i + c;
+					TYPE *y = dst + (long long)N2 * c;
+					auto column = [&](int n) { return src[(long long)wide * n + c]; };
+					auto twiddle = [&](int k, TYPE v) {
+						long long m = n1 * k;
+						y[k] = v * (coarse[m / N2] * fine[m % N2]);
+					};
+					cols(store(scratch.get<TYPE>(N2), twiddle), load(column));
+				});
+			},
+			[&](int i) { return transfer(true, out, slab[2 + i % 2].data(), (long long)width(i, wide1, N1) * N2, (long long)wide1 * i * N2); });
+		auto middle = std::chrono::steady_clock::now();
+		done = done && pipeline(blocks2,
+			[&](int i) { return segments(false, out, slab[i % 3].data(), N1, width(i, wide2, N2), N2, (long long)wide2 * i); },
+			[&](int i) {
+				const int wide = width(i, wide2, N2);
+				TYPE *buf = slab[i % 3].data();
+				workers(wide, [&](int j, int) {
+					Scratch scratch;
+					auto column = [&](int n) { return buf[(long long)wide * n + j]; };
+					auto back = [&](int k, TYPE v) { buf[(long long)wide * k + j] = v; };
+					rows(store(scratch.get<TYPE>(N1), back), load(column));
+				});
+			},
+			[&](int i) { return segments(true, out, slab[i % 3].data(), N1, width(i, wide2, N2), N2, (long long)wide2 * i); });
+		auto end = std::chrono::steady_clock::now();
+		seconds[0] = std::chrono::duration<double>(middle - start).count();
+		seconds[1] = std::chrono::duration<double>(end - middle).count();
+		return done;
+	}
+	// creates or truncates the file out
+	bool operator ()(const char *out, const char *in)
+	{
+		int ifd = open(in, O_RDONLY);
+		if (ifd < 0) {
+			error = std::string(in) + ": " + std::strerror(errno);
+			return false;
+		}
+		struct stat st;
+		if (fstat(ifd, &st) || st.st_size < off_t(BINS * sizeof(TYPE))) {
+			error = std::string(in) + ": shorter than " + std::to_string(BINS) + " samples";
+			close(ifd);
+			return false;
+		}
+		int ofd = open(out, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (ofd < 0 || ftruncate(ofd, BINS * sizeof(TYPE))) {
+			error = std::string(out) + ": " + std::strerror(errno);
+			if (ofd >= 0)
+				close(ofd);
+			close(ifd);
+			return false;
+		}
+		bool done = (*this)(ofd, ifd);
+		close(ifd);
+		if (close(ofd) && done) {
+			error = std::string(out) + ": " + std::strerror(errno);
+			done = false;
+		}
+		return done;
+	}
+};
+
+template <int N1, int N2, typename TYPE>
+class OutOfCoreForward : public OutOfCore<N1, N2, TYPE, -1>
+{
+public:
+	OutOfCoreForward(size_t memory = size_t(1) << 30, int threads = 1) : OutOfCore<N1, N2, TYPE, -1>(memory, threads) {}
+};
+
+template <int N1, int N2, typename TYPE>
+class OutOfCoreBackward : public OutOfCore<N1, N2, TYPE, 1>
+{
+public:
+	OutOfCoreBackward(size_t memory = size_t(1) << 30, int threads = 1) : OutOfCore<N1, N2, TYPE, 1>(memory, threads) {}
+};
+
+}
+
+#endif
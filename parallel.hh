@@ -0,0 +1,104 @@
+/*
+parallel - reusable pool of worker threads
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef PARALLEL_HH
+#define PARALLEL_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FFT {
+
+class Workers
+{
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake, done;
+	std::atomic<int> next;
+	void (*call)(void *, int, int);
+	void *context;
+	int total, busy, generation;
+	bool quit;
+
+	template <typename FUNC>
+	static void trampoline(void *func, int item, int thread)
+	{
+		(*static_cast<FUNC *>(func))(item, thread);
+	}
+	void work(int thread)
+	{
+		for (int item; (item = next++) < total;)
+			call(context, item, thread);
+	}
+	void loop(int thread)
+	{
+		for (int seen = 0;;) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&]{ return quit || generation != seen; });
+				if (quit)
+					return;
+				seen = generation;
+			}
+			work(thread);
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!--busy)
+				done.notify_one();
+		}
+	}
+public:
+	Workers(int count = 1) : next(0), call(0), context(0), total(0), busy(0), generation(0), quit(false)
+	{
+		for (int i = 1; i < count; ++i)
+			threads.emplace_back(&Workers::loop, this, i);
+	}
+	~Workers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		wake.notify_all();
+		for (auto &thread: threads)
+			thread.join();
+	}
+	Workers(const Workers &) = delete;
+	Workers &operator = (const Workers &) = delete;
+	inline int size() const
+	{
+		return threads.size() + 1;
+	}
+	// calls func(item, thread) for every item in [0, count), thread is in [0, size())
+	template <typename FUNC>
+	void operator ()(int count, FUNC func)
+	{
+		if (threads.empty() || count < 2) {
+			for (int item = 0; item < count; ++item)
+				func(item, 0);
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			call = trampoline<FUNC>;
+			context = &func;
+			total = count;
+			next = 0;
+			busy = threads.size();
+			++generation;
+		}
+		wake.notify_all();
+		work(0);
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [this]{ return !busy; });
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*
+peaks - spectral peak detection fused into the fft
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef PEAKS_HH
+#define PEAKS_HH
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include "memory.hh"
+#include "spectrum.hh"
+
+namespace FFT {
+
+template <typename TYPE>
+struct Peak
+{
+	TYPE bin, power;
+};
+
+/*
+The last butterfly stage stores only the real valued power of each bin and
+sums it up for the mean. A single pass then keeps the COUNT strongest local
+maxima above threshold times the mean power, sorted by decreasing power.
+Positions and powers are refined by fitting a parabola to the logarithm of
+the power, which is exact for the Gaussian like main lobe of the window.
+The noise floor leaves out the main lobe of every peak, as wide as the
+spectrum of the window takes to fall to its first minimum, two bins either
+side for Hann, one for a rectangle and three for Blackman.
+*/
+template <int BINS, int COUNT, typename TYPE>
+class Peaks
+{
+public:
+	typedef typename TYPE::value_type value_type;
+private:
+	Forward<BINS, TYPE> fwd;
+	value_type power[BINS];
+	value_type window[BINS];
+	bool masked[BINS];
+	value_type energy;
+	int lobe;
+	static inline value_type log(value_type a)
+	{
+		return std::log(std::max(a, std::numeric_limits<value_type>::min()));
+	}
+	inline value_type at(int k) const
+	{
+		return power[(k + BINS) % BINS];
+	}
+	void refine(Peak<value_type> *peak, int k) const
+	{
+		value_type a = log(at(k - 1)), b = log(at(k)), c = log(at(k + 1));
+		value_type d = a - value_type(2) * b + c;
+		value_type delta = d < value_type(0) ? value_type(0.5) * (a - c) / d : value_type(0);
+		peak->bin = value_type(k) + delta;
+		if (peak->bin < value_type(0))
+			peak->bin += value_type(BINS);
+		peak->power = std::exp(b - value_type(0.25) * (a - c) * delta);
+	}
+public:
+	Peaks()
+	{
+		Hann<BINS, value_type> hann;
+		init(hann);
+	}
+	Peaks(const value_type *w)
+	{
+		init(w);
+	}
+	void init(const value_type *w)
+	{
+		energy = 0;
+		for (int n = 0; n < BINS; ++n) {
+			energy += (window[n] = w[n]) * w[n];
+			masked[n] = false;
+		}
+		// |W(f)|^2 in steps of a sixteenth of a bin until it stops falling
+		const int STEPS = 16;
+		double last = 0;
+		lobe = BINS / 2;
+		for (int i = 0; i <= STEPS * (BINS / 2); ++i) {
+			std::complex<double> sum, z(1), step(std::polar(1.0, -2 * M_PI * i / (STEPS * double(BINS))));
+			for (int n = 0; n < BINS; ++n, z *= step)
+				sum += double(w[n]) * z;
+			double mag = std::norm(sum);
+			if (i && mag >= last) {
+				lobe = std::max(1, (i - 1 + STEPS - 1) / STEPS);
+				break;
+			}
+			last = mag;
+		}
+	}
+	// bins either side of a peak that belong to its main lobe
+	int main_lobe() const
+	{
+		return lobe;
+	}
+	// returns the number of peaks found, noise receives the mean power of the bins outside their main lobes
+	template <typename SAMPLE>
+	int operator ()(Peak<value_type> *peaks, value_type *noise, const SAMPLE *in, value_type threshold)
+	{
+		value_type scale = value_type(1) / energy, sum = 0;
+		auto frame = [&](int n) { return window[n] * TYPE(in[n]); };
+		auto store = [&](int k, TYPE v) { sum += power[k] = scale * norm(v); };
+		Scratch scratch;
+		fwd(FFT::store(scratch.get<TYPE>(BINS), store), load(frame));
+		value_type limit = threshold * sum / value_type(BINS);
+		int bins[COUNT], found = 0;
+		for (int k = 0; k < BINS; ++k) {
+			value_type p = power[k];
+			if (p <= limit || p <= at(k - 1) || p < at(k + 1))
+				continue;
+			if (found == COUNT && p <= power[bins[COUNT - 1]])
+				continue;
+			int i = found < COUNT ? found++ : COUNT - 1;
+			for (; i > 0 && power[bins[i - 1]] < p; --i)
+				bins[i] = bins[i - 1];
+			bins[i] = k;
+		}
+		for (int i = 0; i < found; ++i)
+			refine(peaks + i, bins[i]);
+		if (noise) {
+			// lobes may overlap and wrap around, so mark them and sum the rest
+			for (int i = 0; i < found; ++i)
+				for (int k = bins[i] - lobe; k <= bins[i] + lobe; ++k)
+					masked[(k + BINS) % BINS] = true;
+			value_type rest = 0;
+			int count = 0;
+			for (int k = 0; k < BINS; ++k) {
+				if (masked[k]) {
+					masked[k] = false;
+				} else {
+					rest += power[k];
+					++count;
+				}
+			}
+			*noise = count > 0 ? rest / value_type(count) : value_type(0);
+		}
+		return found;
+	}
+	// frames of BINS samples hop apart, COUNT peaks, one count and one noise value per frame
+	template <typename SAMPLE>
+	void operator ()(Peak<value_type> *peaks, int *found, value_type *noise, const SAMPLE *in, int frames, int hop, value_type threshold)
+	{
+		for (int i = 0; i < frames; ++i)
+			found[i] = (*this)(peaks + COUNT * i, noise ? noise + i : 0, in + hop * i, threshold);
+	}
+};
+
+}
+
+#endif
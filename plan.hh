@@ -0,0 +1,310 @@
+/*
+plan - measuring planner with wisdom kept per cpu model
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef PLAN_HH
+#define PLAN_HH
+
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace FFT {
+
+static inline std::string cpu_model()
+{
+	std::ifstream cpuinfo("/proc/cpuinfo");
+	std::string line;
+	while (std::getline(cpuinfo, line)) {
+		if (line.compare(0, 10, "model name"))
+			continue;
+		size_t colon = line.find(':');
+		if (colon != std::string::npos)
+			return line.substr(line.find_first_not_of(" \t", colon + 1));
+	}
+	return "unknown";
+}
+
+/*
+ESTIMATE takes the order of split unless there is wisdom, MEASURE times the
+orders taking the odd primes from the largest down, EXHAUSTIVE times all
+orders with more rounds each.
+*/
+enum Effort { ESTIMATE, MEASURE, EXHAUSTIVE };
+
+// how the complex type is named in the wisdom, so types of the same precision keep their own decisions
+template <typename TYPE>
+struct WisdomType
+{
+	static std::string name()
+	{
+		return "complex" + std::to_string(8 * sizeof(typename TYPE::value_type));
+	}
+};
+
+template <typename T>
+struct WisdomType<std::complex<T>>
+{
+	static std::string name()
+	{
+		return "std" + std::to_string(8 * sizeof(T));
+	}
+};
+
+/*
+The fastest factorization found for a size, direction and complex type, one
+line per decision in the form "bins sign type effort radices cpu model".
+Decisions made on other cpus are kept and saved again, but only those of
+this cpu are used. Wisdom is only taken if it was found with at least the
+effort asked for.
+*/
+class Wisdom
+{
+	struct Entry
+	{
+		int bins, sign, effort;
+		std::string type, radices, cpu;
+	};
+	std::vector<Entry> entries;
+	std::mutex mutex;
+	std::string cpu;
+	static const char *name(int effort)
+	{
+		static const char *names[] = { "estimate", "measure", "exhaustive" };
+		return names[effort];
+	}
+public:
+	Wisdom() : cpu(cpu_model()) {}
+	static Wisdom &global()
+	{
+		static Wisdom wisdom;
+		return wisdom;
+	}
+	const std::string &model() const
+	{
+		return cpu;
+	}
+	// adds the entries of a file, later lines replace earlier ones, nothing is added if any line is malformed
+	bool load(const char *file)
+	{
+		std::ifstream in(file);
+		if (!in)
+			return false;
+		std::vector<Entry> parsed;
+		std::string line;
+		while (std::getline(in, line)) {
+			if (line.empty() || line[0] == '#')
+				continue;
+			std::istringstream fields(line);
+			Entry entry;
+			std::string effort;
+			if (!(fields >> entry.bins >> entry.sign >> entry.type >> effort >> entry.radices))
+				return false;
+			entry.effort = -1;
+			for (int e = ESTIMATE; e <= EXHAUSTIVE; ++e)
+				if (effort == name(e))
+					entry.effort = e;
+			std::getline(fields >> std::ws, entry.cpu);
+			if (entry.effort < 0 || entry.cpu.empty())
+				return false;
+			parsed.push_back(entry);
+		}
+		if (in.bad())
+			return false;
+		for (const Entry &entry : parsed)
+			remember(entry);
+		return true;
+	}
+	bool save(const char *file)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::ofstream out(file);
+		out << "# bins sign type effort radices cpu" << std::endl;
+		for (const Entry &e : entries)
+			out << e.bins << " " << e.sign << " " << e.type << " " << name(e.effort) << " " << e.radices << " " << e.cpu << std::endl;
+		return bool(out);
+	}
+	bool lookup(std::string *radices, int bins, int sign, const std::string &type, Effort effort)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (const Entry &e : entries) {
+			if (e.bins == bins && e.sign == sign && e.type == type && e.cpu == cpu && e.effort >= effort) {
+				*radices = e.radices;
+				return true;
+			}
+		}
+		return false;
+	}
+	void remember(int bins, int sign, const std::string &type, Effort effort, const std::string &radices)
+	{
+		remember(Entry { bins, sign, effort, type, radices, cpu });
+	}
+	void forget()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.clear();
+	}
+private:
+	void remember(const Entry &entry)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (Entry &e : entries) {
+			if (e.bins == entry.bins && e.sign == entry.sign && e.type == entry.type && e.cpu == entry.cpu) {
+				e = entry;
+				return;
+			}
+		}
+		entries.push_back(entry);
+	}
+};
+
+// policy 0 is Dit in the order of split, the others go through Chain
+template <int POLICY, int BINS, typename TYPE, int SIGN>
+struct Engine
+{
+	static void dit(TYPE *out, const TYPE *in, const TYPE *z)
+	{
+		Recursion<Policy<POLICY>, BINS, TYPE, SIGN>::dit(out, in, z);
+	}
+	static std::string radices()
+	{
+		std::string list;
+		for (int n = BINS, r; n > 1; n /= r)
+			list += (list.empty() ? "" : "x") + std::to_string(r = factor(n, POLICY));
+		return list;
+	}
+};
+
+/*
+Picks one of the engines at run time. Engines with the same factorization
+are only timed once, every round times all candidates in turn, so a change
+of the clock speed affects them alike, and the best round counts. The
+timings stay in candidates for inspection, empty if wisdom was used.
+*/
+template <int BINS, typename TYPE, int SIGN>
+class Planned
+{
+	typedef void (*Kernel)(TYPE *, const TYPE *, const TYPE *);
+	Factors<BINS, TYPE, SIGN> factors;
+	Kernel kernels[POLICIES], kernel;
+	std::string names[POLICIES], chosen;
+	template <int... P>
+	void engines(Indices<P...>)
+	{
+		Kernel k[] = { Engine<P, BINS, TYPE, SIGN>::dit... };
+		std::string n[] = { Engine<P, BINS, TYPE, SIGN>::radices()... };
+		for (int p = 0; p < POLICIES; ++p) {
+			kernels[p] = k[p];
+			names[p] = n[p];
+		}
+	}
+	void choose(int policy)
+	{
+		kernel = kernels[policy];
+		chosen = names[policy];
+	}
+	void measure(Effort effort)
+	{
+		typedef typename TYPE::value_type value_type;
+		std::vector<TYPE> in(BINS), out(BINS);
+		for (int n = 0; n < BINS; ++n)
+			in[n] = TYPE(value_type(n % 7) - value_type(3), value_type(n % 5) - value_type(2));
+		std::vector<int> policies;
+		for (int p = 0; p < POLICIES; ++p) {
+			bool seen = effort == MEASURE && p / 3 % 2;
+			for (int q : policies)
+				seen = seen || names[q] == names[p];
+			if (!seen)
+				policies.push_back(p);
+		}
+		const int rounds = effort == EXHAUSTIVE ? 15 : 5;
+		const double target = effort == EXHAUSTIVE ? 0.002 : 0.0005;
+		int count = 1;
+		for (;; count *= 2) {
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < count; ++i)
+				kernels[0](out.data(), in.data(), factors);
+			if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= target)
+				break;
+		}
+		std::vector<double> best(policies.size(), 1e300);
+		for (int round = 0; round < rounds; ++round) {
+			for (size_t c = 0; c < policies.size(); ++c) {
+				Kernel k = kernels[policies[c]];
+				auto start = std::chrono::steady_clock::now();
+				for (int i = 0; i < count; ++i)
+					k(out.data(), in.data(), factors);
+				double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				best[c] = std::min(best[c], seconds / count);
+			}
+		}
+		size_t fastest = 0;
+		for (size_t c = 0; c < policies.size(); ++c) {
+			candidates.push_back(Candidate { names[policies[c]], 1e9 * best[c] });
+			if (best[c] < best[fastest])
+				fastest = c;
+		}
+		choose(policies[fastest]);
+	}
+public:
+	typedef typename TYPE::value_type value_type;
+	struct Candidate
+	{
+		std::string radices;
+		double ns;
+	};
+	std::vector<Candidate> candidates;
+	Planned(Effort effort = MEASURE, Wisdom &wisdom = Wisdom::global())
+	{
+		engines(typename Sequence<POLICIES>::type());
+		choose(0);
+		const std::string type = WisdomType<TYPE>::name();
+		std::string radices;
+		if (wisdom.lookup(&radices, BINS, SIGN, type, effort)) {
+			for (int p = 0; p < POLICIES; ++p) {
+				if (names[p] == radices) {
+					choose(p);
+					return;
+				}
+			}
+		}
+		if (effort == ESTIMATE)
+			return;
+		measure(effort);
+		wisdom.remember(BINS, SIGN, type, effort, chosen);
+	}
+	// radices from the first stage to the leaves, like 5x3x2x8x8
+	const std::string &factorization() const
+	{
+		return chosen;
+	}
+	inline void operator ()(TYPE *out, const TYPE *in)
+	{
+		kernel(out, in, factors);
+	}
+};
+
+template <int BINS, typename TYPE>
+class PlannedForward : public Planned<BINS, TYPE, -1>
+{
+public:
+	PlannedForward(Effort effort = MEASURE, Wisdom &wisdom = Wisdom::global()) : Planned<BINS, TYPE, -1>(effort, wisdom) {}
+};
+
+template <int BINS, typename TYPE>
+class PlannedBackward : public Planned<BINS, TYPE, 1>
+{
+public:
+	PlannedBackward(Effort effort = MEASURE, Wisdom &wisdom = Wisdom::global()) : Planned<BINS, TYPE, 1>(effort, wisdom) {}
+};
+
+}
+
+#endif
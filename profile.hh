@@ -0,0 +1,360 @@
+/*
+profile - per stage call counts, cycles and hardware counters of the recursion
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef PROFILE_HH
+#define PROFILE_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+Compiled in with -DFFT_PROFILE only, every dit of fft.hh then starts with a
+Probe. Without FFT_PROFILE the probes expand to nothing, so the kernels are
+exactly the same code as before.
+*/
+#define FFT_PROBE(RADIX, BINS, STRIDE, SIGN) ::FFT::Probe fft_probe(RADIX, BINS, STRIDE, SIGN)
+
+namespace FFT {
+
+/*
+Instructions, cache misses and branch misses of this thread, from
+perf_event_open, read with rdpmc when the kernel allows it and with a
+system call otherwise. Missing counters, in virtual machines or with
+perf_event_paranoid above 2, read as zero.
+*/
+class Counters
+{
+public:
+	static const int EVENTS = 3;
+private:
+	int fd[EVENTS];
+#ifdef __linux__
+	perf_event_mmap_page *page[EVENTS];
+#endif
+public:
+	std::string error;
+	Counters()
+	{
+		for (int e = 0; e < EVENTS; ++e)
+			fd[e] = -1;
+#ifdef __linux__
+		const uint64_t config[EVENTS] = {
+			PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES,
+			PERF_COUNT_HW_BRANCH_MISSES,
+		};
+		for (int e = 0; e < EVENTS; ++e) {
+			page[e] = 0;
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = config[e];
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fd[e] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+			if (fd[e] < 0) {
+				error = std::strerror(errno);
+				continue;
+			}
+			void *map = mmap(0, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fd[e], 0);
+			if (map != MAP_FAILED)
+				page[e] = static_cast<perf_event_mmap_page *>(map);
+		}
+#else
+		error = "no perf_event_open";
+#endif
+	}
+	~Counters()
+	{
+#ifdef __linux__
+		for (int e = 0; e < EVENTS; ++e) {
+			if (page[e])
+				munmap(page[e], sysconf(_SC_PAGESIZE));
+			if (fd[e] >= 0)
+				close(fd[e]);
+		}
+#endif
+	}
+	bool available() const
+	{
+		return error.empty();
+	}
+	static const char *name(int e)
+	{
+		static const char *names[EVENTS] = { "instructions", "cache misses", "branch misses" };
+		return names[e];
+	}
+	inline uint64_t read(int e) const
+	{
+#ifdef __linux__
+#if defined(__x86_64__) || defined(__i386__)
+		if (page[e] && page[e]->cap_user_rdpmc) {
+			volatile perf_event_mmap_page *pc = page[e];
+			uint32_t seq;
+			uint64_t count;
+			do {
+				seq = pc->lock;
+				__asm__ __volatile__ ("" ::: "memory");
+				uint32_t index = pc->index;
+				count = pc->offset;
+				if (index) {
+					int width = pc->pmc_width;
+					uint64_t pmc = __rdpmc(index - 1);
+					count += int64_t(pmc << (64 - width)) >> (64 - width);
+				}
+				__asm__ __volatile__ ("" ::: "memory");
+			} while (pc->lock != seq);
+			return count;
+		}
+#endif
+		uint64_t value;
+		if (fd[e] >= 0 && ::read(fd[e], &value, sizeof(value)) == sizeof(value))
+			return value;
+#else
+		(void)e;
+#endif
+		return 0;
+	}
+	// time stamp counter or nanoseconds
+	static inline uint64_t ticks()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+	static const char *unit()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		return "cycles";
+#else
+		return "ns";
+#endif
+	}
+};
+
+/*
+One stage of the recursion, Dit<RADIX, BINS, STRIDE, TYPE, SIGN>, under the
+stage that called it. A stage has only ever one kind of child, the sub
+transform it splits into, so finding the child is a short linear search.
+The costs are inclusive, the children are subtracted in the report.
+*/
+struct Node
+{
+	int radix, bins, stride, sign;
+	Node *parent;
+	std::vector<Node *> children;
+	uint64_t calls, ticks, events[Counters::EVENTS];
+	Node(int radix, int bins, int stride, int sign, Node *parent) :
+		radix(radix), bins(bins), stride(stride), sign(sign), parent(parent), calls(0), ticks(0)
+	{
+		for (int e = 0; e < Counters::EVENTS; ++e)
+			events[e] = 0;
+	}
+	~Node()
+	{
+		for (Node *child : children)
+			delete child;
+	}
+	inline Node *child(int r, int b, int s, int d)
+	{
+		for (Node *c : children)
+			if (c->radix == r && c->bins == b && c->stride == s && c->sign == d)
+				return c;
+		children.push_back(new Node(r, b, s, d, this));
+		return children.back();
+	}
+	void reset()
+	{
+		calls = ticks = 0;
+		for (int e = 0; e < Counters::EVENTS; ++e)
+			events[e] = 0;
+		for (Node *child : children)
+			child->reset();
+	}
+};
+
+/*
+The recursion trees of all transforms since the last reset, for one thread
+at a time. The cost of the probes themselves is measured once and taken out
+in the report: what a parent sees of each call to a child and what a probe
+measures of itself. So the self costs are close to those without
+instrumentation, but the probes still disturb caches and the pipeline.
+*/
+class Profile
+{
+	Counters counters;
+	Node root;
+	Node *current;
+	bool calibrated;
+	uint64_t outer[Counters::EVENTS + 1], inner[Counters::EVENTS + 1];
+	Profile() : root(0, 0, 0, 0, 0), current(&root), calibrated(false) {}
+	void calibrate();
+	static uint64_t less(uint64_t a, uint64_t b)
+	{
+		return a > b ? a - b : 0;
+	}
+	static uint64_t descendants(const Node *node)
+	{
+		uint64_t calls = 0;
+		for (const Node *child : node->children)
+			calls += child->calls + descendants(child);
+		return calls;
+	}
+	// cost e of node and its children, ticks for e == EVENTS
+	uint64_t inclusive(const Node *node, int e = Counters::EVENTS) const
+	{
+		uint64_t raw = e < Counters::EVENTS ? node->events[e] : node->ticks;
+		return less(raw, inner[e] * node->calls + outer[e] * descendants(node));
+	}
+	void print(std::ostream &out, const Node *node, int depth, uint64_t total) const
+	{
+		uint64_t all = inclusive(node), self = all;
+		uint64_t events[Counters::EVENTS];
+		for (int e = 0; e < Counters::EVENTS; ++e)
+			events[e] = inclusive(node, e);
+		for (const Node *child : node->children) {
+			self = less(self, inclusive(child));
+			for (int e = 0; e < Counters::EVENTS; ++e)
+				events[e] = less(events[e], inclusive(child, e));
+		}
+		std::string name = std::string(2 * depth, ' ') + "Dit<" + std::to_string(node->radix) + ", " +
+			std::to_string(node->bins) + ", " + std::to_string(node->stride) + ", " + std::to_string(node->sign) + ">";
+		out << std::left << std::setw(40) << name << std::right;
+		out << std::setw(12) << node->calls << std::setw(14) << all << std::setw(14) << self;
+		out << std::setw(7) << std::fixed << std::setprecision(1) << (total ? 100.0 * self / total : 0.0) << "%";
+		out << std::setw(11) << std::setprecision(1) << (node->calls ? double(self) / node->calls : 0.0);
+		out.unsetf(std::ios::floatfield);
+		for (int e = 0; e < Counters::EVENTS; ++e) {
+			if (counters.available())
+				out << std::setw(15) << events[e];
+			else
+				out << std::setw(15) << "n/a";
+		}
+		out << std::endl;
+		for (const Node *child : node->children)
+			print(out, child, depth + 1, total);
+	}
+public:
+	static Profile &instance()
+	{
+		static Profile profile;
+		return profile;
+	}
+	inline const Counters &hardware() const
+	{
+		return counters;
+	}
+	inline Node *enter(int radix, int bins, int stride, int sign)
+	{
+		Node *node = current->child(radix, bins, stride, sign);
+		current = node;
+		return node;
+	}
+	inline void leave(Node *node)
+	{
+		current = node->parent;
+	}
+	static void reset()
+	{
+		instance().root.reset();
+	}
+	// one tree per transform called since the last reset, with self and inclusive costs per stage
+	static void report(std::ostream &out)
+	{
+		Profile &profile = instance();
+		if (!profile.calibrated)
+			profile.calibrate();
+		out << "probe overhead of " << profile.outer[Counters::EVENTS] << " " << Counters::unit() << " per call removed";
+		if (!profile.counters.available())
+			out << ", hardware counters unavailable: " << profile.counters.error;
+		out << std::endl;
+		out << std::left << std::setw(40) << "stage" << std::right << std::setw(12) << "calls";
+		out << std::setw(14) << Counters::unit() << std::setw(14) << "self" << std::setw(8) << "self%" << std::setw(11) << "per call";
+		for (int e = 0; e < Counters::EVENTS; ++e)
+			out << std::setw(15) << Counters::name(e);
+		out << std::endl;
+		for (const Node *node : profile.root.children)
+			profile.print(out, node, 0, profile.inclusive(node));
+	}
+};
+
+class Probe
+{
+	Node *node;
+	uint64_t start, begin[Counters::EVENTS];
+public:
+	inline Probe(int radix, int bins, int stride, int sign)
+	{
+		Profile &profile = Profile::instance();
+		node = profile.enter(radix, bins, stride, sign);
+		for (int e = 0; e < Counters::EVENTS; ++e)
+			begin[e] = profile.hardware().read(e);
+		start = Counters::ticks();
+	}
+	inline ~Probe()
+	{
+		uint64_t stop = Counters::ticks();
+		Profile &profile = Profile::instance();
+		for (int e = 0; e < Counters::EVENTS; ++e)
+			node->events[e] += profile.hardware().read(e) - begin[e];
+		node->ticks += stop - start;
+		++node->calls;
+		profile.leave(node);
+	}
+};
+
+// empty probes under a scratch node, the best of a few rounds
+inline void Profile::calibrate()
+{
+	const int COUNT = 10000, ROUNDS = 5;
+	Node scratch(0, 0, 0, 0, current);
+	Node *saved = current;
+	current = &scratch;
+	for (int e = 0; e <= Counters::EVENTS; ++e)
+		outer[e] = inner[e] = ~uint64_t(0);
+	for (int round = 0; round < ROUNDS; ++round) {
+		uint64_t begin[Counters::EVENTS + 1];
+		for (int e = 0; e < Counters::EVENTS; ++e)
+			begin[e] = counters.read(e);
+		begin[Counters::EVENTS] = Counters::ticks();
+		for (int i = 0; i < COUNT; ++i)
+			Probe probe(0, 0, 0, 0);
+		uint64_t end = Counters::ticks();
+		Node *empty = scratch.children[0];
+		for (int e = 0; e <= Counters::EVENTS; ++e) {
+			uint64_t seen = (e < Counters::EVENTS ? counters.read(e) : end) - begin[e];
+			uint64_t own = e < Counters::EVENTS ? empty->events[e] : empty->ticks;
+			outer[e] = std::min(outer[e], seen / COUNT);
+			inner[e] = std::min(inner[e], own / COUNT);
+		}
+		empty->reset();
+	}
+	current = saved;
+	calibrated = true;
+}
+
+}
+
+#endif
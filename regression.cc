@@ -0,0 +1,209 @@
+/*
+regression - compare benchmark results against a baseline
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+#include <cmath>
+
+struct Samples
+{
+	std::vector<double> times;
+	double error = 0, growth = 0;
+};
+
+// type, complex, size and cache
+typedef std::tuple<std::string, std::string, int, std::string> Key;
+
+struct Table
+{
+	std::string cpu;
+	std::map<Key, Samples> rows;
+};
+
+static std::vector<std::string> fields(const std::string &line)
+{
+	std::vector<std::string> list;
+	std::stringstream stream(line);
+	std::string field;
+	while (std::getline(stream, field, ','))
+		list.push_back(field);
+	return list;
+}
+
+// csv written by benchmark --csv, with one row per run, type, complex, size and cache
+static bool read(Table &table, const char *name)
+{
+	std::ifstream csv(name);
+	if (!csv) {
+		std::cerr << "could not open " << name << std::endl;
+		return false;
+	}
+	std::map<std::string, size_t> column;
+	std::string line;
+	while (std::getline(csv, line)) {
+		if (line.empty())
+			continue;
+		if (line[0] == '#') {
+			if (!line.compare(0, 7, "# cpu: "))
+				table.cpu = line.substr(7);
+			continue;
+		}
+		std::vector<std::string> list = fields(line);
+		if (column.empty()) {
+			for (size_t i = 0; i < list.size(); ++i)
+				column[list[i]] = i;
+			const char *names[] = { "type", "complex", "size", "cache", "median_ns", "error", "growth" };
+			for (const char *field : names) {
+				if (!column.count(field)) {
+					std::cerr << "column " << field << " missing in " << name << std::endl;
+					return false;
+				}
+			}
+			continue;
+		}
+		if (list.size() < column.size())
+			continue;
+		Key key(list[column["type"]], list[column["complex"]], std::atoi(list[column["size"]].c_str()), list[column["cache"]]);
+		Samples &samples = table.rows[key];
+		samples.times.push_back(std::atof(list[column["median_ns"]].c_str()));
+		samples.error = std::max(samples.error, std::atof(list[column["error"]].c_str()));
+		samples.growth = std::max(samples.growth, std::atof(list[column["growth"]].c_str()));
+	}
+	if (column.empty()) {
+		std::cerr << "no header in " << name << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// two sided 95% quantile of the t distribution, rounded down to the table
+static double t95(double df)
+{
+	static const double table[][2] = {
+		{ 1, 12.706 }, { 2, 4.303 }, { 3, 3.182 }, { 4, 2.776 }, { 5, 2.571 },
+		{ 6, 2.447 }, { 7, 2.365 }, { 8, 2.306 }, { 9, 2.262 }, { 10, 2.228 },
+		{ 12, 2.179 }, { 15, 2.131 }, { 20, 2.086 }, { 30, 2.042 }, { 60, 2.000 }, { 120, 1.980 },
+	};
+	double t = table[0][1];
+	for (auto &row : table)
+		if (row[0] <= df)
+			t = row[1];
+	return df > 120 ? 1.960 : t;
+}
+
+static void moments(double *mean, double *var, const std::vector<double> &times)
+{
+	double sum = 0, sum2 = 0;
+	for (double t : times)
+		sum += std::log(t);
+	*mean = sum / times.size();
+	for (double t : times)
+		sum2 += (std::log(t) - *mean) * (std::log(t) - *mean);
+	*var = times.size() > 1 ? sum2 / (times.size() - 1) : 0;
+}
+
+static void usage(const char *name)
+{
+	std::cerr << "usage: " << name << " [--threshold PERCENT] [--accuracy PERCENT] baseline.csv current.csv" << std::endl;
+	std::cerr << "  --threshold PERCENT  slowdown that fails, default 5" << std::endl;
+	std::cerr << "  --accuracy PERCENT   error increase that fails, default 50" << std::endl;
+}
+
+/*
+Times are compared as ratios, so the means and the Welch interval are taken
+over the logarithms of the per run medians. A size only counts as slower if
+the whole 95% interval of the slowdown lies above the threshold, so noise
+on a busy machine does not fail the check, while more runs narrow the
+interval. The errors come from a fixed seed and are compared directly, but
+differences below one ulp of the type are ignored.
+*/
+int main(int argc, char **argv)
+{
+	double threshold = 0.05, accuracy = 0.5;
+	std::vector<const char *> names;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg(argv[i]);
+		if (arg == "--threshold" && i + 1 < argc) {
+			threshold = std::atof(argv[++i]) / 100;
+		} else if (arg == "--accuracy" && i + 1 < argc) {
+			accuracy = std::atof(argv[++i]) / 100;
+		} else if (arg.compare(0, 2, "--")) {
+			names.push_back(argv[i]);
+		} else {
+			usage(argv[0]);
+			return arg == "--help" ? 0 : 1;
+		}
+	}
+	if (names.size() != 2) {
+		usage(argv[0]);
+		return 1;
+	}
+	Table baseline, current;
+	if (!read(baseline, names[0]) || !read(current, names[1]))
+		return 1;
+	if (baseline.cpu != current.cpu)
+		std::cerr << "warning: baseline measured on \"" << baseline.cpu << "\", current on \"" << current.cpu << "\"" << std::endl;
+
+	int slower = 0, faster = 0, worse = 0, missing = 0, compared = 0;
+	std::cout << "  type      complex    size cache  baseline ns   current ns  change  95% interval        error ratio" << std::endl;
+	for (auto &row : baseline.rows) {
+		auto it = current.rows.find(row.first);
+		if (it == current.rows.end()) {
+			++missing;
+			continue;
+		}
+		++compared;
+		const Samples &b = row.second, &c = it->second;
+		double mb, vb, mc, vc;
+		moments(&mb, &vb, b.times);
+		moments(&mc, &vc, c.times);
+		double diff = mc - mb, lo = diff, hi = diff;
+		if (b.times.size() > 1 && c.times.size() > 1) {
+			double sb = vb / b.times.size(), sc = vc / c.times.size(), se = std::sqrt(sb + sc);
+			if (se > 0) {
+				double df = (sb + sc) * (sb + sc) / (sb * sb / (b.times.size() - 1) + sc * sc / (c.times.size() - 1));
+				lo = diff - t95(df) * se;
+				hi = diff + t95(df) * se;
+			}
+		}
+		const std::string &type = std::get<0>(row.first);
+		double ulp = type == "float" ? std::numeric_limits<float>::epsilon() : std::numeric_limits<double>::epsilon();
+		double ratio = std::max(c.error, ulp) / std::max(b.error, ulp);
+		double growth = std::max(c.growth, ulp) / std::max(b.growth, ulp);
+		const char *verdict = "";
+		if (std::exp(lo) - 1 > threshold) {
+			verdict = " SLOWER";
+			++slower;
+		} else if (std::exp(hi) - 1 < -threshold) {
+			verdict = " faster";
+			++faster;
+		}
+		if (std::max(ratio, growth) > 1 + accuracy) {
+			verdict = " LESS ACCURATE";
+			++worse;
+		}
+		std::cout << std::setw(6) << type << " " << std::setw(12) << std::get<1>(row.first) << " " << std::setw(7) << std::get<2>(row.first) << " " << std::setw(4) << std::get<3>(row.first);
+		std::cout << std::fixed << std::setprecision(1);
+		std::cout << " " << std::setw(12) << std::exp(mb) << " " << std::setw(12) << std::exp(mc);
+		std::cout << " " << std::showpos << std::setw(6) << 100 * (std::exp(diff) - 1) << "%";
+		std::cout << " [" << std::setw(6) << 100 * (std::exp(lo) - 1) << "%, " << std::setw(6) << 100 * (std::exp(hi) - 1) << "%]" << std::noshowpos;
+		std::cout << std::defaultfloat << std::setprecision(3) << " " << std::setw(7) << std::max(ratio, growth) << verdict << std::endl;
+	}
+	std::cout << compared << " compared, " << slower << " slower, " << faster << " faster, " << worse << " less accurate";
+	if (missing)
+		std::cout << ", " << missing << " not measured";
+	std::cout << std::endl;
+	return slower || worse;
+}
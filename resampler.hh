@@ -0,0 +1,95 @@
+/*
+resampler - block wise band limited resampling in the frequency domain
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef RESAMPLER_HH
+#define RESAMPLER_HH
+
+#include "memory.hh"
+
+namespace FFT {
+
+static constexpr int gcd(int a, int b)
+{
+	return b ? gcd(b, a % b) : a;
+}
+
+/*
+Changes the sample rate by OUT / IN, for example from 44.1kHz to 48kHz with
+IN 1470 and OUT 1600. Blocks of IN samples are transformed with a Forward,
+the bins up to the lower of both Nyquist frequencies are copied into a
+spectrum of OUT bins while the Forward stores and a Backward gives OUT samples.
+The blocks overlap by two edges of EDGE input samples, about IN / 8, and the
+edges of the output are dropped while the Backward stores, so the circular
+convolution never shows. The band edge is tapered over the last eighth of
+the bins, which keeps the implied interpolation kernel shorter than an edge.
+Every call consumes STEP input samples and produces SKIP output samples,
+delayed by EDGE input samples. Two real signals can be resampled at once in
+the real and imaginary parts.
+*/
+template <int IN, int OUT, typename TYPE>
+class Resampler
+{
+public:
+	typedef typename TYPE::value_type value_type;
+	static const int GCD = gcd(IN, OUT);
+	static const int EDGE = (IN / GCD) * (GCD / 8 ? GCD / 8 : 1);
+	static const int STEP = IN - 2 * EDGE;
+	static const int SKIP = STEP / (IN / GCD) * (OUT / GCD);
+private:
+	static const int EDGE_OUT = EDGE / (IN / GCD) * (OUT / GCD);
+	static const int CUTOFF = (IN < OUT ? IN : OUT) / 2;
+	static const int TAPER = CUTOFF / 8 ? CUTOFF / 8 : 1;
+	static_assert(STEP > 0, "IN and OUT have too few common factors");
+	Forward<IN, TYPE> fwd;
+	Backward<OUT, TYPE> bwd;
+	TYPE spec[OUT];
+	TYPE history[2 * EDGE];
+	value_type taper[CUTOFF];
+public:
+	Resampler()
+	{
+		for (int k = 0; k < CUTOFF; ++k) {
+			value_type w = k < CUTOFF - TAPER ? value_type(1) :
+				value_type(0.5) + value_type(0.5) * std::cos(value_type(M_PI) * value_type(k - (CUTOFF - TAPER) + 1) / value_type(TAPER + 1));
+			taper[k] = w / value_type(IN);
+		}
+		for (int k = 0; k < OUT; ++k)
+			spec[k] = 0;
+		for (int n = 0; n < 2 * EDGE; ++n)
+			history[n] = 0;
+	}
+	void operator ()(TYPE *out, const TYPE *in)
+	{
+		auto block = [&](int n) { return n < 2 * EDGE ? history[n] : in[n - 2 * EDGE]; };
+		auto band = [&](int k, TYPE v) {
+			if (k < CUTOFF)
+				spec[k] = taper[k] * v;
+			else if (IN - k < CUTOFF)
+				spec[OUT - (IN - k)] = taper[IN - k] * v;
+		};
+		auto keep = [&](int n, TYPE v) {
+			if (n >= EDGE_OUT && n < OUT - EDGE_OUT)
+				out[n - EDGE_OUT] = v;
+		};
+		Scratch scratch;
+		TYPE *tmp = scratch.get<TYPE>(IN > OUT ? IN : OUT);
+		fwd(store(tmp, band), load(block));
+		bwd(store(tmp, keep), spec);
+		// the last two edges of the block, which reach back into the history when STEP < 2 * EDGE
+		for (int n = 0; n < 2 * EDGE; ++n)
+			history[n] = STEP + n < 2 * EDGE ? history[STEP + n] : in[STEP + n - 2 * EDGE];
+	}
+	// count * SKIP output samples from count * STEP input samples
+	void operator ()(TYPE *out, const TYPE *in, int count)
+	{
+		for (int i = 0; i < count; ++i)
+			(*this)(out + SKIP * i, in + STEP * i);
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+/*
+spectrum - power spectrum estimation fused into the fft
+To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
+You should have received a copy of the CC0 Public Domain Dedication along with this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+*/
+
+#ifndef SPECTRUM_HH
+#define SPECTRUM_HH
+
+#include <algorithm>
+#include "memory.hh"
+
+namespace FFT {
+
+template <int BINS, typename TYPE>
+class Hann
+{
+	TYPE w[BINS];
+public:
+	Hann()
+	{
+		for (int n = 0; n < BINS; ++n)
+			w[n] = TYPE(0.5) - TYPE(0.5) * std::cos(TYPE(2 * M_PI) * TYPE(n) / TYPE(BINS));
+	}
+	inline operator const TYPE * () const
+	{
+		return w;
+	}
+};
+
+/*
+The window is applied while the leaf kernels load the frame and the squared
+magnitude is added to the real valued result while the last butterfly stage
+stores it, so neither the windowed frame nor the complex spectrum is ever
+written out. Results are normalized by the energy of the window.
+*/
+template <int BINS, typename TYPE>
+class Spectrum
+{
+public:
+	typedef typename TYPE::value_type value_type;
+private:
+	Forward<BINS, TYPE> fwd;
+	value_type window[BINS];
+	value_type energy;
+	template <typename SAMPLE, typename FUNC>
+	void transform(const SAMPLE *in, FUNC &func)
+	{
+		auto frame = [&](int n) { return window[n] * TYPE(in[n]); };
+		Scratch scratch;
+		fwd(store(scratch.get<TYPE>(BINS), func), load(frame));
+	}
+public:
+	Spectrum()
+	{
+		Hann<BINS, value_type> hann;
+		init(hann);
+	}
+	Spectrum(const value_type *w)
+	{
+		init(w);
+	}
+	void init(const value_type *w)
+	{
+		energy = 0;
+		for (int n = 0; n < BINS; ++n)
+			energy += (window[n] = w[n]) * w[n];
+	}
+	// psd += |X|^2 of one frame, for custom averaging
+	template <typename SAMPLE>
+	void accumulate(value_type *psd, const SAMPLE *in)
+	{
+		value_type scale = value_type(1) / energy;
+		auto add = [&](int k, TYPE v) { psd[k] += scale * norm(v); };
+		transform(in, add);
+	}
+	// Welch: average over all frames hop samples apart in [0, length), hop has to be positive, returns the number of frames
+	template <typename SAMPLE>
+	int welch(value_type *psd, const SAMPLE *in, int length, int hop)
+	{
+		for (int k = 0; k < BINS; ++k)
+			psd[k] = 0;
+		if (hop <= 0)
+			return 0;
+		int frames = 0;
+		auto add = [&](int k, TYPE v) { psd[k] += norm(v); };
+		for (int offset = 0; offset + BINS <= length; offset += hop, ++frames)
+			transform(in + offset, add);
+		if (frames) {
+			value_type scale = value_type(1) / (value_type(frames) * energy);
+			for (int k = 0; k < BINS; ++k)
+				psd[k] *= scale;
+		}
+		return frames;
+	}
+	// exponential average: psd = (1 - alpha) * psd + alpha * |X|^2
+	template <typename SAMPLE>
+	void average(value_type *psd, const SAMPLE *in, value_type alpha)
+	{
+		value_type scale = alpha / energy, decay = value_type(1) - alpha;
+		auto mix = [&](int k, TYPE v) { psd[k] = decay * psd[k] + scale * norm(v); };
+		transform(in, mix);
+	}
+	// max hold: psd = max(psd, |X|^2)
+	template <typename SAMPLE>
+	void maxhold(value_type *psd, const SAMPLE *in)
+	{
+		value_type scale = value_type(1) / energy;
+		auto hold = [&](int k, TYPE v) { psd[k] = std::max(psd[k], scale * norm(v)); };
+		transform(in, hold);
+	}
+};
+
+}
+
+#endif